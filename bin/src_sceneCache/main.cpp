@@ -0,0 +1,35 @@
+#include <Kin/kin.h>
+
+const char *USAGE =
+    "\nUsage:  sceneCache <g-filename>"
+    "\n"
+    "\n  -file <g-file>"
+    "\n  -cache <cache-file>  (default: <g-file>.cache)"
+    "\n  -check           only report whether the cache is up to date"
+    "\n  -force           recompile even if the cache is up to date\n";
+
+int main(int argc,char **argv){
+  rai::initCmdLine(argc, argv);
+
+  rai::String file=rai::getParameter<rai::String>("file",STRING("none"));
+  if(rai::argc>=2 && rai::argv[1][0]!='-') file=rai::argv[1];
+  if(file=="none"){ cout <<USAGE <<endl;  return 0; }
+
+  rai::String cache=rai::getParameter<rai::String>("cache",STRING(file <<".cache"));
+
+  bool upToDate = rai::Configuration::checkCache(cache);
+  cout <<"cache '" <<cache <<"' is " <<(upToDate?"up to date":"missing or stale") <<endl;
+  if(rai::checkParameter<bool>("check")) return upToDate?0:1;
+
+  if(!upToDate || rai::checkParameter<bool>("force")){
+    rai::Configuration::compileCache(file, cache);
+    cout <<"compiled '" <<file <<"' into '" <<cache <<"'" <<endl;
+  }
+
+  rai::Configuration C;
+  C.readCache(cache);
+  C.checkConsistency();
+  cout <<"#frames=" <<C.frames.N <<" #dofs=" <<C.getJointStateDimension() <<endl;
+
+  return 0;
+}
@@ -72,6 +72,11 @@ struct ControlThread : Thread {
 
     //Hmetric = rai::getParameter<double>("Hrate", .1)*ctrl_config.get()->getHmetric();
 
+    rtPriority = rai::getParameter<int>("ControlThread/rtPriority", 0);
+    cpuCore = rai::getParameter<int>("ControlThread/cpuCore", -1);
+    lockMemory = rai::getParameter<bool>("ControlThread/lockMemory", false);
+    reportJitter = rai::getParameter<bool>("ControlThread/reportJitter", false);
+
     threadLoop();
   };
   ~ControlThread(){
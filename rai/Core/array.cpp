@@ -19,6 +19,17 @@
 #include "array.h"
 #include "util.h"
 #include "util.ipp"
+#include "profile.h"
+
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef RAI_LAPACK
 extern "C" {
@@ -54,6 +65,7 @@ namespace rai {
 //===========================================================================
 
 bool useLapack=true;
+uint sparseNumThreads=0;
 #ifdef RAI_LAPACK
 const bool lapackSupported=true;
 #else
@@ -65,6 +77,259 @@ const char* arrayElemsep=", ";
 const char* arrayLinesep=",\n ";
 const char* arrayBrackets="[]";
 
+//===========================================================================
+//
+// arena memory
+//
+
+struct alignas(16) ArenaChunk {
+  ArenaChunk* next;
+  size_t used, size;
+  std::atomic<uint> live; ///< number of arrays in this chunk, +1 while the owning scope is alive
+  char* data() { return (char*)(this+1); }
+};
+
+struct ArenaHeader {
+  ArenaChunk* chunk;
+  size_t size; ///< bytes reserved in the chunk, including this header
+};
+
+struct Arena {
+  Arena* prev;
+  size_t chunkSize;
+  ArenaChunk* chunks=0; ///< the first is the one currently bumped
+  const char* frame;    ///< stack frame of the ArenaScope constructor: the locals of all functions called within the scope lie below
+};
+
+static thread_local Arena* arenaCurrent=0;
+
+static size_t arenaAlign(size_t n) { return (n+15)&~size_t(15); }
+
+static void arenaRelease(ArenaChunk* c) {
+  if(--c->live==0) free(c);
+}
+
+ArenaScope::ArenaScope(uint chunkSize) {
+  arena = new Arena;
+  arena->prev = arenaCurrent;
+  arena->chunkSize = chunkSize;
+  arena->frame = (const char*)__builtin_frame_address(0);
+  arenaCurrent = arena;
+}
+
+ArenaScope::~ArenaScope() {
+  CHECK_EQ(arenaCurrent, arena, "ArenaScopes need to be destroyed in reverse order");
+  arenaCurrent = arena->prev;
+  for(ArenaChunk* c=arena->chunks; c;) {
+    ArenaChunk* next=c->next;
+    arenaRelease(c);
+    c=next;
+  }
+  delete arena;
+}
+
+ArenaSuspend::ArenaSuspend() : suspended(arenaCurrent) { arenaCurrent=0; }
+
+ArenaSuspend::~ArenaSuspend() {
+  CHECK(!arenaCurrent, "ArenaScopes opened within an ArenaSuspend need to be closed before it");
+  arenaCurrent = suspended;
+}
+
+/// true if the owner is a local variable of a function called within the scope of a: it lies on
+/// this thread's (downward growing) stack between this call and the frame that opened the scope
+static bool arenaIsLocal(const Arena* a, const void* owner) {
+  char here;
+  return (uintptr_t)owner>(uintptr_t)&here && (uintptr_t)owner<=(uintptr_t)a->frame;
+}
+
+void* memAlloc(size_t size, bool& isArena, const void* owner) {
+  Arena* a = arenaCurrent;
+  if(!a || size>a->chunkSize/4 || !arenaIsLocal(a, owner)) { isArena=false; return malloc(size); } //large or long-lived arrays go to the heap
+  size_t need = arenaAlign(sizeof(ArenaHeader)+size);
+  ArenaChunk* c = a->chunks;
+  if(!c || c->used+need > c->size) {
+    c = (ArenaChunk*)malloc(sizeof(ArenaChunk)+a->chunkSize);
+    if(!c) { HALT("memory allocation failed! Wanted size = " <<a->chunkSize <<"bytes"); }
+    c->next = a->chunks;
+    c->used = 0;
+    c->size = a->chunkSize;
+    new(&c->live) std::atomic<uint>(1);
+    a->chunks = c;
+  }
+  ArenaHeader* h = (ArenaHeader*)(c->data()+c->used);
+  h->chunk = c;
+  h->size = need;
+  c->used += need;
+  c->live++;
+  isArena=true;
+  return h+1;
+}
+
+/// true if h is the last allocation in the currently bumped chunk of this thread
+static bool arenaIsTop(ArenaHeader* h) {
+  Arena* a = arenaCurrent;
+  return a && h->chunk==a->chunks && (char*)h+h->size==h->chunk->data()+h->chunk->used;
+}
+
+void* memRealloc(void* p, size_t oldSize, size_t size, bool& isArena, const void* owner) {
+  if(!isArena) return realloc(p, size);
+  ArenaHeader* h = (ArenaHeader*)p - 1;
+  size_t need = arenaAlign(sizeof(ArenaHeader)+size);
+  if(arenaIsTop(h) && (char*)h+need <= h->chunk->data()+h->chunk->size && arenaIsLocal(arenaCurrent, owner)) { //resize in place
+    h->chunk->used += need - h->size;
+    h->size = need;
+    return p;
+  }
+  void* q = memAlloc(size, isArena, owner); //arrays moved into long-lived owners migrate to the heap
+  if(q) memmove(q, p, oldSize<size ? oldSize : size);
+  memFree(p, true);
+  return q;
+}
+
+void* memRehome(void* p, size_t used, size_t size, bool& isArena, const void* owner) {
+  if(!isArena || (arenaCurrent && arenaIsLocal(arenaCurrent, owner))) return p;
+  void* q = malloc(size);
+  if(!q) { HALT("memory allocation failed! Wanted size = " <<size <<"bytes"); }
+  memmove(q, p, used);
+  memFree(p, true);
+  isArena=false;
+  return q;
+}
+
+void memFree(void* p, bool isArena) {
+  if(!isArena) { free(p); return; }
+  ArenaHeader* h = (ArenaHeader*)p - 1;
+  if(arenaIsTop(h)) h->chunk->used -= h->size; //stack-like temporaries: reuse the memory right away
+  arenaRelease(h->chunk);
+}
+
+//===========================================================================
+//
+// memory-mapped binary array files
+//
+
+/* file layout (native endianness):
+     "rai-arrs"                   8 bytes magic
+     uint32 version, uint32 n     number of arrays
+     n entries:  uint32 len, tag;  uint32 len, type tag (mappedTypeTag);  uint32 elemSize;  uint32 nd, dims[nd];  uint64 offset, size
+     data blocks, each at a 64-byte aligned file offset */
+
+static const char mappedArraysMagic[8] = {'r', 'a', 'i', '-', 'a', 'r', 'r', 's'};
+static const uint32_t mappedArraysVersion = 2; //2: compiler-independent type tags
+
+bool MappedArrays::isMappedFile(const char* filename) {
+  char magic[8];
+  FILE* fil = fopen(filename, "rb");
+  if(!fil) return false;
+  uint32_t version;
+  bool ok = fread(magic, 1, 8, fil)==8 && !memcmp(magic, mappedArraysMagic, 8)
+            && fread(&version, 4, 1, fil)==1 && version==mappedArraysVersion;
+  fclose(fil);
+  return ok;
+}
+
+MappedArrays::MappedArrays(const char* filename, bool copyOnWrite) {
+  int fd = ::open(filename, O_RDONLY);
+  if(fd<0) HALT("could not open mapped array file '" <<filename <<"'");
+  struct stat st;
+  if(fstat(fd, &st)) { ::close(fd); HALT("could not stat '" <<filename <<"'"); }
+  dataSize = st.st_size;
+  void* m = mmap(0, dataSize, copyOnWrite ? PROT_READ|PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); //the mapping keeps the file
+  if(m==MAP_FAILED) HALT("could not mmap '" <<filename <<"'");
+  data = (char*)m;
+
+  //-- parse the header
+  const char* c = data, *end = data+dataSize;
+  auto get = [&](void* x, size_t n) {
+    if(c+n>end) HALT("mapped array file '" <<filename <<"' is truncated");
+    memcpy(x, c, n);
+    c += n;
+  };
+  auto getString = [&](std::string& str) {
+    uint32_t len;
+    get(&len, 4);
+    if(c+len>end) HALT("mapped array file '" <<filename <<"' is truncated");
+    str.assign(c, len);
+    c += len;
+  };
+  char magic[8];
+  uint32_t version, n;
+  get(magic, 8);
+  if(memcmp(magic, mappedArraysMagic, 8)) HALT("'" <<filename <<"' is not a mapped array file");
+  get(&version, 4);
+  if(version!=mappedArraysVersion) HALT("mapped array file '" <<filename <<"' has version " <<version);
+  get(&n, 4);
+  entries.resize(n);
+  for(Entry& e:entries) {
+    uint32_t nd;
+    getString(e.tag);
+    getString(e.type);
+    get(&e.elemSize, 4);
+    get(&nd, 4);
+    e.dim.resize(nd);
+    if(nd) get(e.dim.data(), 4*nd);
+    get(&e.offset, 8);
+    get(&e.size, 8);
+    if(e.offset+e.size>dataSize || e.offset%64) HALT("mapped array file '" <<filename <<"': corrupt entry '" <<e.tag <<"'");
+  }
+}
+
+MappedArrays::~MappedArrays() {
+  if(data) munmap(data, dataSize);
+}
+
+const MappedArrays::Entry* MappedArrays::find(const char* tag) const {
+  for(const Entry& e:entries) if(e.tag==tag) return &e;
+  return 0;
+}
+
+void MappedArraysWriter::write(const char* filename) const {
+  //-- header
+  std::string head(mappedArraysMagic, 8);
+  auto put = [&](const void* x, size_t n) { head.append((const char*)x, n); };
+  auto putString = [&](const std::string& str) { uint32_t len=str.size(); put(&len, 4); head.append(str); };
+  uint32_t n = entries.size();
+  put(&mappedArraysVersion, 4);
+  put(&n, 4);
+  size_t headSize = head.size();
+  for(const MappedArrays::Entry& e:entries) headSize += 4+e.tag.size() + 4+e.type.size() + 4 + 4+4*e.dim.size() + 16;
+
+  //-- aligned offsets
+  std::vector<uint64_t> offsets(entries.size());
+  uint64_t off = headSize;
+  for(uint i=0; i<entries.size(); i++) {
+    off = (off+63) & ~uint64_t(63);
+    offsets[i] = off;
+    off += entries[i].size;
+  }
+  for(uint i=0; i<entries.size(); i++) {
+    const MappedArrays::Entry& e = entries[i];
+    uint32_t nd = e.dim.size();
+    putString(e.tag);
+    putString(e.type);
+    put(&e.elemSize, 4);
+    put(&nd, 4);
+    if(nd) put(e.dim.data(), 4*nd);
+    put(&offsets[i], 8);
+    put(&e.size, 8);
+  }
+  CHECK_EQ(head.size(), headSize, "");
+
+  //-- write
+  FILE* fil = fopen(filename, "wb");
+  if(!fil) HALT("could not open '" <<filename <<"' for writing");
+  bool ok = fwrite(head.data(), 1, head.size(), fil)==head.size();
+  static const char zeros[64] = {0};
+  uint64_t pos = head.size();
+  for(uint i=0; i<entries.size() && ok; i++) {
+    if(offsets[i]>pos) ok = fwrite(zeros, 1, offsets[i]-pos, fil)==offsets[i]-pos;
+    if(entries[i].size) ok = ok && fwrite(buffers[i], 1, entries[i].size, fil)==entries[i].size;
+    pos = offsets[i]+entries[i].size;
+  }
+  if(fclose(fil) || !ok) HALT("could not write '" <<filename <<"'");
+}
+
 //===========================================================================
 }
 
@@ -875,12 +1140,12 @@ void sparseProduct(arr& y, arr& A, const arr& x) {
     return;
   }
   if(isSparseMatrix(A) && isSparseVector(x)) {
-    A.sparse().setupRowsCols();
+    rai::SparseMatrix& As = A.sparse();
+    As.ensureRowsCols();
     rai::SparseVector* sx = dynamic_cast<rai::SparseVector*>(x.special);
     CHECK(x.nd==1 && A.nd==2 && x.d0==A.d1, "not a proper matrix-vector multiplication");
     uint i, j, n;
     int* k, *kstop;
-    uint* l, *lstop;
     y.sparseVec();
     y.d0 = A.d0;
     intA& y_elems= dynamic_cast<rai::SparseVector*>(y.special)->elems;
@@ -888,10 +1153,9 @@ void sparseProduct(arr& y, arr& A, const arr& x) {
     intA& x_elems = sx->elems;
     for(k=x_elems.p, kstop=x_elems.p+x_elems.N; k!=kstop; xp++) {
       j=*k; k++;
-      uintA& A_col = dynamic_cast<rai::SparseMatrix*>(A.special)->cols(j);
-      for(l=A_col.p, lstop=A_col.p+A_col.N; l!=lstop;) {
-        i =*l; l++;
-        n =*l; l++;
+      for(int l=As.colPtr.p[j], lstop=As.colPtr.p[j+1]; l<lstop; l++) {
+        i = As.colRow.p[l];
+        n = As.colMem.p[l];
 #if 0
         slot=&y_col(i);
         if(*slot==(uint)-1) {
@@ -1246,18 +1510,11 @@ void blas_MsymMsym(arr& X, const arr& A, const arr& B) {
 #endif //RAI_NOBLAS
 
 arr lapack_Ainv_b_sym(const arr& A, const arr& b) {
+  RAI_PROFILE_FUNCTION;
   if(isSparseMatrix(A)) {
     return eigen_Ainv_b(A, b);
   }
   arr x;
-  if(b.nd==2) { //b is a matrix (unusual) repeat for each col:
-    RAI_MSG("TODO: directly call lapack with the matrix!")
-    arr bT = ~b;
-    x.resizeAs(bT);
-    for(uint i=0; i<bT.d0; i++) x[i].noconst() = lapack_Ainv_b_sym(A, bT[i]);
-    x=~x;
-    return x;
-  }
   integer N=A.d0, KD=0, NRHS=1, LDAB=0, INFO;
   if(isRowShifted(A)) {
     rai::RowShifted* Aaux = dynamic_cast<rai::RowShifted*>(A.special);
@@ -1266,7 +1523,12 @@ arr lapack_Ainv_b_sym(const arr& A, const arr& b) {
     KD=Aaux->rowSize-1;
     LDAB=Aaux->rowSize;
   }
-  x=b;
+  if(b.nd==2) { //b is a matrix: factorize once and solve for all columns (lapack is column-major -> transpose b)
+    NRHS=b.d1;
+    x=~b;
+  } else {
+    x=b;
+  }
   arr Acol=A;
   try {
     if(!isRowShifted(A)) {
@@ -1305,6 +1567,7 @@ arr lapack_Ainv_b_sym(const arr& A, const arr& b) {
 //    THROW("lapack_Ainv_b_sym error info = " <<INFO
 //         <<". Typically this is because A is not pos-def.\nsmallest "<<k<<" eigenvalues=" <<sig);
   }
+  if(b.nd==2) x=~x;
   return x;
 }
 
@@ -1313,6 +1576,7 @@ uint lapack_SVD(
   arr& d,
   arr& Vt,
   const arr& A) {
+  RAI_PROFILE_FUNCTION;
   arr Atmp, work;
   Atmp=A;
   //transpose(Atmp, A);
@@ -1350,6 +1614,7 @@ void lapack_RQ(arr& R, arr& Q, const arr& A) {
 }
 
 void lapack_EigenDecomp(const arr& symmA, arr& Evals, arr& Evecs) {
+  RAI_PROFILE_FUNCTION;
   CHECK(symmA.nd==2 && symmA.d0==symmA.d1, "not symmetric");
   arr work, symmAcopy = symmA;
   integer N=symmA.d0;
@@ -1393,6 +1658,7 @@ bool lapack_isPositiveSemiDefinite(const arr& symmA) {
 
 /// A=C^T C (C is upper triangular!)
 void lapack_cholesky(arr& C, const arr& A) {
+  RAI_PROFILE_FUNCTION;
   CHECK_EQ(A.d0, A.d1, "");
   integer n=A.d0;
   integer info;
@@ -1414,6 +1680,7 @@ const char* potrf_ERR="\n\
 *                completed.\n";
 
 void lapack_mldivide(arr& X, const arr& A, const arr& B) {
+  RAI_PROFILE_FUNCTION;
   if(isSparseMatrix(A)) {
     X = eigen_Ainv_b(A, B);
     return;
@@ -1437,6 +1704,7 @@ void lapack_mldivide(arr& X, const arr& A, const arr& B) {
 }
 
 void lapack_choleskySymPosDef(arr& Achol, const arr& A) {
+  RAI_PROFILE_FUNCTION;
   if(isRowShifted(A)) {
     rai::RowShifted* Aaux = dynamic_cast<rai::RowShifted*>(A.special);
     if(!Aaux->symmetric) HALT("this is not a symmetric matrix");
@@ -1455,6 +1723,7 @@ void lapack_choleskySymPosDef(arr& Achol, const arr& A) {
 }
 
 void lapack_inverseSymPosDef(arr& Ainv, const arr& A) {
+  RAI_PROFILE_FUNCTION;
   Ainv=A;
   integer N=A.d0, LDAB=A.d1, INFO;
   //compute cholesky
@@ -1476,6 +1745,7 @@ double lapack_determinantSymPosDef(const arr& A) {
 }
 
 void lapack_min_Ax_b(arr& x, const arr& A, const arr& b) {
+  RAI_PROFILE_FUNCTION;
   CHECK(A.d0>=A.d1 && A.d0==b.N && b.nd==1 && A.nd==2, "");
   arr At = ~A;
   x=b;
@@ -1560,36 +1830,76 @@ Eigen::SparseMatrix<double> conv_sparseArr2sparseEigen(const rai::SparseMatrix&
   arr& Z = S.Z;
   Eigen::SparseMatrix<double> E;
   E.resize(Z.d0, Z.d1);
-  std::vector<Eigen::Triplet<double>> triplets;
-  triplets.reserve(Z.N);
-  for(uint k=0; k<Z.N; k++){
-    int i=S.elems.p[2*k];
-    int j=S.elems.p[2*k+1];
-    if(i>=0 && j>=0) triplets.push_back(Eigen::Triplet<double>(i, j, Z.p[k]));
+  if(!S.hasRowsCols()) {
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(Z.N);
+    for(uint k=0; k<Z.N; k++){
+      int i=S.elems.p[2*k];
+      int j=S.elems.p[2*k+1];
+      if(i>=0 && j>=0) triplets.push_back(Eigen::Triplet<double>(i, j, Z.p[k]));
+    }
+    E.setFromTriplets(triplets.begin(), triplets.end());
+    return E;
+  }
+
+  //directly fill Eigen's compressed storage from the CSC index, summing duplicates
+  S.checkRowsCols();
+  uint n=S.colRow.N;
+  E.resizeNonZeros(n);
+  int* outer = E.outerIndexPtr();
+  int* inner = E.innerIndexPtr();
+  double* val = E.valuePtr();
+  if(S.isCSC) {
+    memmove(outer, S.colPtr.p, sizeof(int)*(Z.d1+1));
+    memmove(inner, S.colRow.p, sizeof(int)*n);
+    memmove(val, Z.p, sizeof(double)*n);
+    return E;
+  }
+  int m=0;
+  for(uint j=0; j<Z.d1; j++) {
+    outer[j]=m;
+    for(int l=S.colPtr.p[j], lstop=S.colPtr.p[j+1]; l<lstop; l++) {
+      if(m>outer[j] && inner[m-1]==S.colRow.p[l]) { val[m-1] += Z.p[S.colMem.p[l]]; continue; }
+      inner[m] = S.colRow.p[l];
+      val[m] = Z.p[S.colMem.p[l]];
+      m++;
+    }
   }
-  E.setFromTriplets(triplets.begin(), triplets.end());
+  outer[Z.d1]=m;
+  E.resizeNonZeros(m);
   return E;
-//  cout <<E <<endl;
+}
+
+Eigen::Map<const Eigen::SparseMatrix<double>> conv_sparseArr2sparseEigenView(const rai::SparseMatrix& S) {
+  CHECK(S.isCSC, "a zero-copy view requires the memory to be in CSC order (e.g., the output of At_A)");
+  return Eigen::Map<const Eigen::SparseMatrix<double>>(S.Z.d0, S.Z.d1, S.Z.N, S.colPtr.p, S.colRow.p, S.Z.p);
 }
 
 arr conv_sparseEigen2sparseArr(Eigen::SparseMatrix<double>& E) {
+  E.makeCompressed();
   arr X;
   rai::SparseMatrix& Xs = X.sparse();
   Xs.resize(E.rows(), E.cols(), E.nonZeros());
 
-  uint n=0;
-  for(int k=0; k<E.outerSize(); ++k) {
-    for(Eigen::SparseMatrix<double>::InnerIterator it(E, k); it; ++it) {
-      Xs.entry(it.row(), it.col(), n) = it.value();
-      n++;
+  //Eigen's compressed storage is column-major -> the memory of X is in CSC order
+  memmove(X.p, E.valuePtr(), sizeof(double)*X.N);
+  int* e=Xs.elems.p;
+  const int* inner=E.innerIndexPtr();
+  for(int j=0; j<E.outerSize(); j++) {
+    for(int l=E.outerIndexPtr()[j], lstop=E.outerIndexPtr()[j+1]; l<lstop; l++) {
+      *(e++) = inner[l];
+      *(e++) = j;
     }
   }
+  Xs.setupRowsCols();
   return X;
 }
 
 arr eigen_Ainv_b(const arr& A, const arr& b) {
+  RAI_PROFILE_FUNCTION;
   if(isSparseMatrix(A)) {
     rai::SparseMatrix& As = *dynamic_cast<rai::SparseMatrix*>(A.special);
+    As.ensureRowsCols();
     Eigen::SparseMatrix<double> Aeig = conv_sparseArr2sparseEigen(As);
     Eigen::MatrixXd beig = conv_arr2eigen(b);
     if(A.d0==A.d1) { //square matrix
@@ -1624,12 +1934,76 @@ arr eigen_Ainv_b(const arr& A, const arr& b) {
   return NoArr;
 }
 
+struct rai::sSparseSymSolver {
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt;
+  std::vector<int> outer, inner; ///< compressed pattern of the last analyzed matrix
+  bool analyzed=false;
+
+  bool samePattern(const Eigen::SparseMatrix<double>& A) {
+    if(!analyzed) return false;
+    if(outer.size()!=(size_t)A.outerSize()+1 || inner.size()!=(size_t)A.nonZeros()) return false;
+    if(memcmp(outer.data(), A.outerIndexPtr(), outer.size()*sizeof(int))) return false;
+    if(memcmp(inner.data(), A.innerIndexPtr(), inner.size()*sizeof(int))) return false;
+    return true;
+  }
+
+  void storePattern(const Eigen::SparseMatrix<double>& A) {
+    outer.assign(A.outerIndexPtr(), A.outerIndexPtr()+A.outerSize()+1);
+    inner.assign(A.innerIndexPtr(), A.innerIndexPtr()+A.nonZeros());
+    analyzed=true;
+  }
+};
+
+rai::SparseSymSolver::SparseSymSolver() : self(make_unique<sSparseSymSolver>()) {}
+
+rai::SparseSymSolver::~SparseSymSolver() {}
+
+void rai::SparseSymSolver::clear() {
+  self->outer.clear();
+  self->inner.clear();
+  self->analyzed=false;
+}
+
+arr rai::SparseSymSolver::solve(const arr& A, const arr& b) {
+  if(!isSparseMatrix(A)) return lapack_Ainv_b_sym(A, b);
+  CHECK_EQ(A.d0, A.d1, "SparseSymSolver requires a square matrix");
+
+  rai::SparseMatrix& As = *dynamic_cast<rai::SparseMatrix*>(A.special);
+  As.ensureRowsCols();
+  Eigen::SparseMatrix<double> Aeig = conv_sparseArr2sparseEigen(As);
+  if(!self->samePattern(Aeig)) {
+    self->ldlt.analyzePattern(Aeig);
+    self->storePattern(Aeig);
+    numAnalyze++;
+  }
+  self->ldlt.factorize(Aeig);
+  numFactorize++;
+  if(self->ldlt.info()!=Eigen::Success) {
+    clear(); //enforce a fresh analysis with the next call
+    HALT("decomposition failed");
+  }
+  Eigen::MatrixXd x = self->ldlt.solve(conv_arr2eigen(b));
+  if(self->ldlt.info()!=Eigen::Success) {
+    HALT("solving failed");
+  }
+  return conv_eigen2arr(x);
+}
+
 #else //RAI_EIGEN
 
 //Eigen::SparseMatrix<double> conv_sparseArr2sparseEigen(const rai::SparseMatrix& S){ NICO }
 //arr conv_sparseEigen2sparseArr(Eigen::SparseMatrix<double>& E){ NICO }
 arr eigen_Ainv_b(const arr& A, const arr& b) { NICO }
 
+struct rai::sSparseSymSolver {};
+rai::SparseSymSolver::SparseSymSolver() {}
+rai::SparseSymSolver::~SparseSymSolver() {}
+void rai::SparseSymSolver::clear() {}
+arr rai::SparseSymSolver::solve(const arr& A, const arr& b) {
+  if(!isSparseMatrix(A)) return lapack_Ainv_b_sym(A, b);
+  NICO
+}
+
 #endif //RAI_EIGEN
 
 //===========================================================================
@@ -2008,6 +2382,11 @@ SparseVector::SparseVector(arr& _Z, const SparseVector& s) : SparseVector(_Z) {
 
 SparseMatrix::SparseMatrix(arr& _Z, const SparseMatrix& s) : SparseMatrix(_Z) {
   elems = s.elems;
+  if(s.hasRowsCols()) {
+    rowPtr = s.rowPtr;  rowCol = s.rowCol;  rowMem = s.rowMem;
+    colPtr = s.colPtr;  colRow = s.colRow;  colMem = s.colMem;
+    isCSC = s.isCSC;  rowsColsN = s.rowsColsN;
+  }
 }
 
 /// return fraction of non-zeros in the array
@@ -2031,6 +2410,7 @@ SparseMatrix& SparseMatrix::resize(uint d0, uint d1, uint n) {
   Z.setZero();
   elems.resize(n, 2);
   for(int& e:elems) e=-1;
+  clearRowsCols();
   return *this;
 }
 
@@ -2042,10 +2422,12 @@ void SparseMatrix::resizeCopy(uint d0, uint d1, uint n) {
   elems.resizeCopy(n, 2);
 //  for(uint i=Nold; i<n; i++) elems(i, 0) = elems(i, 1) =-1;
   for(int *p=elems.p+2*Nold, *pstop=elems.p+2*n; p<pstop; p++) *p = -1;
+  clearRowsCols();
 }
 
 void SparseMatrix::reshape(uint d0, uint d1) {
   Z.nd=2; Z.d0=d0; Z.d1=d1;
+  clearRowsCols();
 }
 
 double& SparseVector::entry(uint i, uint k) {
@@ -2064,7 +2446,7 @@ double& SparseMatrix::entry(uint i, uint j, uint k) {
   if(*elemsk==-1) { //new element
     elemsk[0]=i;
     elemsk[1]=j;
-    if(rows.nd){ rows.clear(); cols.clear(); }
+    clearRowsCols();
   } else {
     CHECK_EQ(elemsk[0], (int)i, "");
     CHECK_EQ(elemsk[1], (int)j, "");
@@ -2073,13 +2455,12 @@ double& SparseMatrix::entry(uint i, uint j, uint k) {
 }
 
 double& SparseMatrix::elem(uint i, uint j) {
-  if(rows.N) {
-    uintA& r = rows(i);
-    uintA& c = cols(j);
-    if(r.N < c.N) {
-      for(uint rj=0; rj<r.d0; rj++) if(r(rj, 0)==j) return Z.elem(r(rj, 1));
+  if(hasRowsCols()) {
+    checkRowsCols();
+    if(rowPtr.p[i+1]-rowPtr.p[i] < colPtr.p[j+1]-colPtr.p[j]) {
+      for(int l=rowPtr.p[i]; l<rowPtr.p[i+1]; l++) if(rowCol.p[l]==(int)j) return Z.p[rowMem.p[l]];
     } else {
-      for(uint ci=0; ci<c.d0; ci++) if(c(ci, 0)==i) return Z.elem(c(ci, 1));
+      for(int l=colPtr.p[j]; l<colPtr.p[j+1]; l++) if(colRow.p[l]==(int)i) return Z.p[colMem.p[l]];
     }
   } else {
     for(uint k=0; k<elems.d0; k++)
@@ -2111,7 +2492,7 @@ double& SparseMatrix::addEntry(int i, int j) {
   elems.resizeCopy(k+1, 2);
   elems(k, 0)=i;
   elems(k, 1)=j;
-  if(rows.nd){ rows.clear(); cols.clear(); }
+  clearRowsCols();
   Z.resizeMEM(k+1, true);
   Z.elem(-1)=0.;
   return Z.elem(-1);
@@ -2133,12 +2514,11 @@ arr SparseMatrix::getSparseRow(uint i) const {
   }
 #else
   SparseMatrix& S = v.sparse();
-  if(rows.N) {
-    uintA& r = rows(i);
-    uint n=r.d0;
+  if(hasRowsCols()) {
+    int lo=rowPtr.p[i], n=rowPtr.p[i+1]-lo;
     S.resize(1, Z.d1, n);
-    for(uint k=0; k<n; k++) {
-      S.entry(0, r(k, 0), k) = Z.elem(r(k, 1));
+    for(int k=0; k<n; k++) {
+      S.entry(0, rowCol.p[lo+k], k) = Z.p[rowMem.p[lo+k]];
     }
   } else {
     NIY
@@ -2185,21 +2565,75 @@ void SparseMatrix::setFromDense(const arr& X) {
     }
 }
 
+/// builds the compressed row (CSR) and column (CSC) indices by counting sorts in O(N+d0+d1)
 void SparseMatrix::setupRowsCols() {
-  rows.resize(Z.d0);
-  cols.resize(Z.d1);
-  for(uint i=0; i<Z.d0; i++) rows(i).resize(0, 2);
-  for(uint j=0; j<Z.d1; j++) cols(j).resize(0, 2);
-  for(uint k=0; k<elems.d0; k++) {
-    uint i = elems(k, 0);
-    uint j = elems(k, 1);
-    rows(i).append(uintA{j, k});
-    cols(j).append(uintA{i, k});
+  uint n=elems.d0;
+  const int* e=elems.p;
+
+  //bucket by column (memory order within a column); unset entries (index -1) are skipped
+  colPtr.resize(Z.d1+1).setZero();
+  for(uint k=0; k<n; k++) if(e[2*k]>=0) colPtr.p[e[2*k+1]+1]++;
+  for(uint j=0; j<Z.d1; j++) colPtr.p[j+1] += colPtr.p[j];
+  uint nSet=colPtr.p[Z.d1];
+  uintA tmp(nSet);
+  {
+    intA pos = colPtr;
+    for(uint k=0; k<n; k++) if(e[2*k]>=0) tmp.p[pos.p[e[2*k+1]]++] = k;
+  }
+  n=nSet;
+
+  //stable bucketing by row, visiting columns in order -> columns ascending within a row
+  rowPtr.resize(Z.d0+1).setZero();
+  for(uint l=0; l<n; l++) rowPtr.p[e[2*tmp.p[l]]+1]++;
+  for(uint i=0; i<Z.d0; i++) rowPtr.p[i+1] += rowPtr.p[i];
+  rowCol.resize(n);
+  rowMem.resize(n);
+  {
+    intA pos = rowPtr;
+    for(uint l=0; l<n; l++) {
+      uint k=tmp.p[l];
+      int m=pos.p[e[2*k]]++;
+      rowCol.p[m] = e[2*k+1];
+      rowMem.p[m] = k;
+    }
+  }
+
+  //stable bucketing by column, visiting rows in order -> rows ascending within a column
+  colRow.resize(n);
+  colMem.resize(n);
+  {
+    intA pos = colPtr;
+    for(uint i=0; i<Z.d0; i++) for(int l=rowPtr.p[i]; l<rowPtr.p[i+1]; l++) {
+        int m=pos.p[rowCol.p[l]]++;
+        colRow.p[m] = i;
+        colMem.p[m] = rowMem.p[l];
+      }
   }
+
+  //check whether the memory itself is already in (duplicate-free) CSC order
+  rowsColsN=elems.d0;
+  isCSC=(n==Z.N);
+  for(uint l=0; l<n && isCSC; l++) if(colMem.p[l]!=l) isCSC=false;
+  for(uint j=0; j<Z.d1 && isCSC; j++) for(int l=colPtr.p[j]+1; l<colPtr.p[j+1]; l++) {
+      if(colRow.p[l]==colRow.p[l-1]) { isCSC=false; break; }
+    }
+}
+
+/// cheap consistency check of an existing index: catches entries added or removed without clearRowsCols()
+void SparseMatrix::checkRowsCols() const {
+  CHECK(rowPtr.N==Z.d0+1 && colPtr.N==Z.d1+1 && rowsColsN==elems.d0 && elems.d0==Z.N,
+        "stale row/col index: code that writes 'elems' directly must call clearRowsCols()");
+}
+
+void SparseMatrix::clearRowsCols() {
+  if(!colPtr.N && !rowPtr.N) return;
+  rowPtr.clear();  rowCol.clear();  rowMem.clear();
+  colPtr.clear();  colRow.clear();  colMem.clear();
+  isCSC=false;
 }
 
 void SparseMatrix::rowShift(int shift) {
-  if(rows.nd){ rows.clear(); cols.clear(); }
+  clearRowsCols();
   for(uint i=0; i<elems.d0; i++) {
     int& j = elems(i, 1);
     CHECK_GE(j+shift, 0, "");
@@ -2209,7 +2643,7 @@ void SparseMatrix::rowShift(int shift) {
 }
 
 void SparseMatrix::colShift(int shift) {
-  if(rows.nd){ rows.clear(); cols.clear(); }
+  clearRowsCols();
   for(uint i=0; i<elems.d0; i++) {
     int& j = elems.p[2*i]; //(i, 0);
     CHECK_GE(j+shift, 0, "");
@@ -2218,28 +2652,101 @@ void SparseMatrix::colShift(int shift) {
   }
 }
 
-#ifdef RAI_EIGEN
+/// threads to use for a sparse product with n independent output columns
+static int sparseThreads(uint n) {
+#ifdef _OPENMP
+  int t = rai::sparseNumThreads ? rai::sparseNumThreads : omp_get_max_threads();
+  return std::max(1, std::min<int>(t, n/64)); //at least 64 columns per thread
+#else
+  return 1;
+#endif
+}
 
+/// with a compressed index, each y(j) is summed by one thread over column j (in row order) -> bitwise independent of the thread count
 arr SparseMatrix::At_x(const arr& x) {
-  Eigen::SparseMatrix<double> A_eig = conv_sparseArr2sparseEigen(*this);
-  Eigen::MatrixXd x_eig = conv_arr2eigen(x);
-
-  x_eig = A_eig.transpose() * x_eig;
-
-  arr y(x_eig.rows());
-  for(uint i = 0; i<y.d0; i++) y(i) = x_eig(i, 0);
+  CHECK_EQ(x.N, Z.d0, "");
+  arr y = zeros(Z.d1);
+  if(hasRowsCols()) {
+    checkRowsCols();
+    int nThreads = sparseThreads(Z.d1);
+    #pragma omp parallel for num_threads(nThreads) schedule(static)
+    for(uint j=0; j<Z.d1; j++) {
+      double yj=0.;
+      for(int l=colPtr.p[j]; l<colPtr.p[j+1]; l++) yj += Z.p[colMem.p[l]] * x.p[colRow.p[l]];
+      y.p[j] = yj;
+    }
+    return y;
+  }
+  const int* e=elems.p;
+  for(uint k=0; k<Z.N; k++, e+=2) if(e[0]>=0) y.p[e[1]] += Z.p[k] * x.p[e[0]];
   return y;
 }
 
+/// Gustavson-style product over the CSC and CSR indices; the returned matrix is stored in CSC order.
+/// The columns of H are split into fixed blocks, each computed by one (any) thread, every column always in the same order
+/// -> the result is bitwise independent of the thread count, also if OpenMP provides fewer threads than requested
 arr SparseMatrix::At_A() {
-  Eigen::SparseMatrix<double> s = conv_sparseArr2sparseEigen(*this);
-
-  Eigen::SparseMatrix<double> W(Z.d1, Z.d1);
-  W = s.transpose() * s;
-
-  return conv_sparseEigen2sparseArr(W);
+  ensureRowsCols();
+  uint n=Z.d1;
+  int nBlocks = sparseThreads(n);
+
+  //-- H(:,j) = sum_i A(i,j) A(i,:), accumulated densely per column
+  std::vector<std::vector<int>> Hrow(nBlocks);
+  std::vector<std::vector<double>> Hval(nBlocks);
+  intA Hptr(n+1);
+  #pragma omp parallel for num_threads(nBlocks) schedule(static, 1)
+  for(int b=0; b<nBlocks; b++) {
+    uint jlo=(b*n)/nBlocks, jhi=((b+1)*n)/nBlocks;
+    std::vector<int>& rows=Hrow[b];
+    std::vector<double>& vals=Hval[b];
+    rows.reserve(2*Z.N/nBlocks);
+    vals.reserve(2*Z.N/nBlocks);
+    std::vector<double> w(n);
+    std::vector<int> mark(n, -1), touched(n);
+    for(uint j=jlo; j<jhi; j++) {
+      uint m=0;
+      for(int l=colPtr.p[j]; l<colPtr.p[j+1]; l++) {
+        int i=colRow.p[l];
+        double a_ij = Z.p[colMem.p[l]];
+        for(int r=rowPtr.p[i]; r<rowPtr.p[i+1]; r++) {
+          int c=rowCol.p[r];
+          if(mark[c]!=(int)j) { mark[c]=j; touched[m++]=c; w[c]=0.; }
+          w[c] += Z.p[rowMem.p[r]] * a_ij;
+        }
+      }
+      std::sort(touched.begin(), touched.begin()+m);
+      for(uint l=0; l<m; l++) {
+        rows.push_back(touched[l]);
+        vals.push_back(w[touched[l]]);
+      }
+      Hptr.p[j+1] = m;
+    }
+  }
+  Hptr.p[0] = 0;
+  for(uint j=0; j<n; j++) Hptr.p[j+1] += Hptr.p[j];
+
+  //-- the memory of H is in CSC order: concatenate the column blocks and set up the index
+  arr H;
+  SparseMatrix& S = H.sparse();
+  S.resize(n, n, Hptr.p[n]);
+  #pragma omp parallel for num_threads(nBlocks) schedule(static, 1)
+  for(int b=0; b<nBlocks; b++) {
+    uint jlo=(b*n)/nBlocks, jhi=((b+1)*n)/nBlocks;
+    int lo=Hptr.p[jlo];
+    memmove(H.p+lo, Hval[b].data(), sizeof(double)*Hval[b].size());
+    int* e=S.elems.p+2*lo;
+    const int* row=Hrow[b].data();
+    for(uint j=jlo; j<jhi; j++) for(int l=Hptr.p[j]; l<Hptr.p[j+1]; l++) {
+        *(e++) = *(row++);
+        *(e++) = j;
+      }
+  }
+  S.setupRowsCols();
+  return H;
 }
 
+#ifdef RAI_EIGEN
+
 arr SparseMatrix::A_B(const arr& B) const {
   if(!isSparse(B) && B.N<25){
     arr C;
@@ -2290,8 +2797,6 @@ arr SparseMatrix::B_A(const arr& B) const {
 
 #else //RAI_EIGEN
 
-arr SparseMatrix::At_x(const arr& x) { NICO }
-arr SparseMatrix::At_A() { NICO }
 arr SparseMatrix::A_B(const arr& B) const { NICO }
 arr SparseMatrix::B_A(const arr& B) const { NICO }
 
@@ -2306,12 +2811,13 @@ void SparseMatrix::transpose() {
     elems(i, 0) = elems(i, 1);
     elems(i, 1) = k;
   }
-  if(rows.nd){ cols.clear(); rows.clear(); }
+  clearRowsCols();
 }
 
 void SparseMatrix::rowWiseMult(const arr& a) {
   CHECK_EQ(a.N, Z.d0, "");
-  for(uint k=0; k<Z.N; k++) Z.elem(k) *= a.elem(elems.p[2*k]);
+  const int* e=elems.p;
+  for(uint k=0; k<Z.N; k++, e+=2) Z.p[k] *= a.p[*e];
 }
 
 //void SparseMatrix::add(const SparseMatrix& a, double coeff) {
@@ -2332,6 +2838,7 @@ void SparseMatrix::add(const SparseMatrix& a, uint lo0, uint lo1, double coeff){
   CHECK_LE(lo0+a.Z.d0, Z.d0, "");
   CHECK_LE(lo1+a.Z.d1, Z.d1, "");
   if(!a.Z.N) return; //nothing to add
+  clearRowsCols();
   uint Nold=Z.N;
 #if 1
   Z.resizeMEM(Nold+a.Z.N, true);
@@ -2366,6 +2873,7 @@ void SparseMatrix::add(const arr& B, uint lo0, uint lo1, double coeff){
   }else if(B.nd==1){ //add a column! vector
     CHECK_LE(lo0+B.d0, Z.d0, "");
   }else NIY;
+  clearRowsCols();
   uint Nold=Z.N;
   Z.resizeMEM(Nold+B.N, true);
   memmove(Z.p+Nold, B.p, Z.sizeT*B.N);
@@ -2438,18 +2946,17 @@ void SparseMatrix::checkConsistency() const {
     CHECK_LE(elems(i,0), (int)Z.d0, "");
     CHECK_LE(elems(i,1), (int)Z.d1, "");
   }
-  if(cols.N){
-    CHECK_EQ(rows.N, Z.d0, "");
-    CHECK_EQ(cols.N, Z.d1, "");
-    for(uint i=0; i<Z.d0; i++) for(uint k=0;k<rows(i).d0;k++){
-      CHECK_EQ(elems(rows(i)(k,1), 0), (int)i, "");
-      CHECK_EQ(elems(rows(i)(k,1), 1), (int)rows(i)(k,0), "");
+  if(hasRowsCols()){
+    CHECK_EQ(rowPtr.N, Z.d0+1, "");
+    CHECK_EQ(colPtr.N, Z.d1+1, "");
+    for(uint i=0; i<Z.d0; i++) for(int l=rowPtr(i);l<rowPtr(i+1);l++){
+      CHECK_EQ(elems(rowMem(l), 0), (int)i, "");
+      CHECK_EQ(elems(rowMem(l), 1), rowCol(l), "");
     }
-    for(uint j=0; j<Z.d1; j++) for(uint k=0;k<cols(j).d0;k++){
-      CHECK_EQ(elems(cols(j)(k,1), 1), (int)j, "");
-      CHECK_EQ(elems(cols(j)(k,1), 0), (int)cols(j)(k,0), "");
+    for(uint j=0; j<Z.d1; j++) for(int l=colPtr(j);l<colPtr(j+1);l++){
+      CHECK_EQ(elems(colMem(l), 1), (int)j, "");
+      CHECK_EQ(elems(colMem(l), 0), colRow(l), "");
     }
-
   }
 }
 
@@ -13,6 +13,11 @@
 #include <initializer_list>
 #include <tuple>
 #include <iostream>
+#include <vector>
+#include <string>
+#include <typeinfo>
+#include <cstdint>
+#include <type_traits>
 
 using std::endl;
 
@@ -45,6 +50,34 @@ template<class T> struct ArrayModRaw;
 template<class T> struct ArrayModList;
 struct SpecialArray;
 
+#define ARRAY_smallMem 128 //bytes of inline memory of each Array (16 doubles)
+
+/** Scoped bump allocator: while an ArenaScope is alive, the memory of (memmove-able) Arrays that are
+  local variables of functions called within the scope (i.e., that live on this thread's stack below the
+  frame that opened it) is served from its chunks instead of the heap; scopes may be nested. All other
+  Arrays -- locals of the opening function, members of heap objects, statics, caches -- keep using the
+  heap, so they never pin chunks; arena memory moved into such an Array is copied to the heap. Arrays
+  may outlive the scope: a chunk is released when the scope and all its arrays are gone. */
+struct ArenaScope {
+  struct Arena* arena;
+  ArenaScope(uint chunkSize=1<<16);
+  ~ArenaScope();
+};
+
+/** Suspends the current ArenaScope (if any) on this thread: allocations within go to the heap.
+  Only needed for local Arrays within a scope that are known to outlive it by far. */
+struct ArenaSuspend {
+  struct Arena* suspended;
+  ArenaSuspend();
+  ~ArenaSuspend();
+};
+
+//memory of memmove-able Arrays: heap (malloc/realloc/free) or the current ArenaScope (depending on where the owning Array lives)
+void* memAlloc(size_t size, bool& isArena, const void* owner);
+void* memRealloc(void* p, size_t oldSize, size_t size, bool& isArena, const void* owner);
+void* memRehome(void* p, size_t used, size_t size, bool& isArena, const void* owner); ///< moves arena memory taken over by a long-lived owner to the heap
+void memFree(void* p, bool isArena);
+
 /** Simple array container to store arbitrary-dimensional arrays (tensors).
   Can buffer more memory than necessary for faster
   resize; enables non-const reference of subarrays; enables fast
@@ -60,8 +93,11 @@ template<class T> struct Array {
   uint d0, d1, d2; ///< 0th, 1st, 2nd dim
   uint* d;  ///< pointer to dimensions (for nd<=3 points to d0)
   bool isReference; ///< true if this refers to memory of another array
+  bool isArena;     ///< true if the memory was allocated from an ArenaScope
   uint M;   ///< memory allocated (>=N)
   SpecialArray* special=0; ///< auxiliary data, e.g. if this is a sparse matrics, depends on special type
+  static constexpr uint smallBytes = std::is_scalar<T>::value ? ARRAY_smallMem : 0; ///< size of the inline memory: only scalar types (numbers, enums, pointers) have one
+  alignas(smallBytes ? 16 : 1) char smallMem[smallBytes ? smallBytes : 1]; ///< inline memory, used instead of the heap for small memmove-able arrays; views alias it (and keep the old memory when this array is moved or taken over)
 
   static int  sizeT;   ///< constant for each type T: stores the sizeof(T)
   static char memMove; ///< constant for each type T: decides whether memmove can be used instead of individual copies
@@ -110,6 +146,7 @@ template<class T> struct Array {
   const_iterator end() const { return const_iterator{p+N}; }
 
   /// @name resizing
+  bool isSmall() const { return p==(T*)smallMem; } ///< true if the inline memory is used
   Array<T>& resize(uint D0);
   Array<T>& resize(uint D0, uint D1);
   Array<T>& resize(uint D0, uint D1, uint D2);
@@ -332,6 +369,79 @@ template <class T> ArrayModList<T> Array<T>::modList() const{ return ArrayModLis
 
 template <class T> std::ostream& operator<<(std::ostream& os, const ArrayModList<T>& x) { x.write(os); return os; }
 
+//===========================================================================
+/// @}
+/// @name memory-mapped binary array files
+/// @{
+
+/** @brief binary file holding several tagged arrays of memMove-able types. A header lists, for
+    each array, tag, element type, dimensions and data offset; each data block is 64-byte aligned.
+    Opening a file mmaps it, and get<T>() returns an Array<T> that refers directly into the mapping
+    (no parsing, no copy). Initializing an Array<T> from it ('floatA x = M.get<float>(tag)') moves
+    the reference; converting ('arr x = M.get<double>(tag)') or assigning ('x = M.get<float>(tag)')
+    copies -- use x.referTo(M.get<double>(tag)). By default the mapping is read-only (writing into
+    it segfaults); with copyOnWrite the arrays may be modified, and pages are copied privately on
+    first write, never touching the file. The referring arrays are only valid as long as the
+    MappedArrays lives. */
+struct MappedArrays {
+  struct Entry { std::string tag, type; uint elemSize; std::vector<uint> dim; uint64_t offset, size; };
+  std::vector<Entry> entries;
+  char* data=0;
+  size_t dataSize=0;
+
+  MappedArrays(const char* filename, bool copyOnWrite=false);
+  ~MappedArrays();
+  MappedArrays(const MappedArrays&) = delete;
+
+  const Entry* find(const char* tag) const;
+  bool has(const char* tag) const { return find(tag); }
+  template<class T> Array<T> get(const char* tag) const;
+
+  static bool isMappedFile(const char* filename); ///< true if the file is a mapped array file of the current version
+};
+
+/// compiler-independent element type tag of mapped arrays: kind and byte size, e.g. "f8" for double, "u4" for uint
+template<class T> std::string mappedTypeTag() {
+  char kind = std::is_same<T, bool>::value ? 'b' : std::is_floating_point<T>::value ? 'f' : std::is_integral<T>::value ? (std::is_signed<T>::value ? 'i' : 'u') : 'v';
+  return kind+std::to_string(sizeof(T));
+}
+
+/// collects tagged arrays (by reference -- they need to live until write) and writes a MappedArrays file
+struct MappedArraysWriter {
+  std::vector<MappedArrays::Entry> entries;
+  std::vector<const char*> buffers;
+
+  template<class T> MappedArraysWriter& add(const char* tag, const Array<T>& x);
+  void write(const char* filename) const;
+};
+
+template<class T> Array<T> MappedArrays::get(const char* tag) const {
+  const Entry* e = find(tag);
+  CHECK(e, "no array tagged '" <<tag <<"' in mapped file");
+  CHECK(e->type==mappedTypeTag<T>() && e->elemSize==sizeof(T), "array '" <<tag <<"' has type " <<e->type <<", not " <<mappedTypeTag<T>());
+  uint64_t n=e->dim.size()?1:0;
+  for(uint d:e->dim) n*=d;
+  CHECK_EQ(e->size, n*sizeof(T), "array '" <<tag <<"' has " <<e->size <<" bytes, but its dimensions need " <<n*sizeof(T));
+  Array<T> x;
+  x.referTo((const T*)(data+e->offset), e->size/sizeof(T));
+  if(e->dim.size()>1) x.reshape(e->dim.size(), (uint*)e->dim.data());
+  return x;
+}
+
+template<class T> MappedArraysWriter& MappedArraysWriter::add(const char* tag, const Array<T>& x) {
+  CHECK(x.memMove && !x.special, "only memMove-able plain arrays can be written to a mapped file");
+  MappedArrays::Entry e;
+  e.tag = tag;
+  e.type = mappedTypeTag<T>();
+  e.elemSize = sizeof(T);
+  for(uint i=0; i<x.nd; i++) e.dim.push_back(x.dim(i));
+  e.offset = 0;
+  e.size = x.N*sizeof(T);
+  entries.push_back(e);
+  buffers.push_back((const char*)x.p);
+  return *this;
+}
+
 } //namespace
 
 //===========================================================================
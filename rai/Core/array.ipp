@@ -47,6 +47,7 @@ template<class T> Array<T>::Array()
     d0(0), d1(0), d2(0),
     d(&d0),
     isReference(false),
+    isArena(false),
     M(0),
     special(0) {
   if(sizeT==-1) sizeT=sizeof(T);
@@ -78,13 +79,18 @@ template<class T> Array<T>::Array(Array<T>&& a)
     d0(a.d0), d1(a.d1), d2(a.d2),
     d(&d0),
     isReference(a.isReference),
+    isArena(a.isArena),
     M(a.M),
     special(a.special){
   //if(a.jac) jac = std::move(a.jac);
   CHECK_EQ(a.d, &a.d0, "");
+  if(a.isSmall()) { p=(T*)smallMem; memmove(p, a.p, sizeT*N); } //inline memory can't be moved, only copied
+  else if(isArena) p=(T*)memRehome(p, sizeT*N, sizeT*M, isArena, this);
   a.p=NULL;
+  a.M=0;
   a.N=a.nd=a.d0=a.d1=a.d2=0;
   a.isReference=false;
+  a.isArena=false;
   a.special=NULL;
 }
 
@@ -110,7 +116,7 @@ template<class T> Array<T>::~Array() {
   if(special) { delete special; special=NULL; }
   if(M) {
     globalMemoryTotal -= M*sizeT;
-    if(memMove==1) free(p); else delete[] p;
+    if(memMove==1) { if(!isSmall()) memFree(p, isArena); } else delete[] p;
   }
 #endif
 }
@@ -294,6 +300,7 @@ template<class T> void Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
 #else
   CHECK_GE(Mnew, n, "");
   CHECK((p && M) || (!p && !M), "");
+  if(memMove==1 && Mnew && Mnew*sizeT<=smallBytes) Mnew=smallBytes/sizeT; //fits into the inline memory
   if(Mnew!=Mold) {  //if M changed, allocate the memory
     globalMemoryTotal -= Mold*sizeT;
     globalMemoryTotal += Mnew*sizeT;
@@ -306,10 +313,18 @@ template<class T> void Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
     }
     if(Mnew) {
       if(memMove==1){
-        if(p){
-          p=(T*)realloc(p, Mnew*sizeT);
+        if(Mnew*sizeT<=smallBytes) { //heap -> inline
+          T* pold=p;
+          p=(T*)smallMem;
+          if(pold) { memmove(p, pold, sizeT*(N<n?N:n)); memFree(pold, isArena); isArena=false; }
+        } else if(isSmall()) { //inline -> heap
+          T* pold=p;
+          p=(T*)memAlloc(Mnew*sizeT, isArena, this);
+          if(p) memmove(p, pold, sizeT*(N<n?N:n));
+        } else if(p){
+          p=(T*)memRealloc(p, Mold*sizeT, Mnew*sizeT, isArena, this);
         } else {
-          p=(T*)malloc(Mnew*sizeT);
+          p=(T*)memAlloc(Mnew*sizeT, isArena, this);
           //memset(p, 0, Mnew*sizeT);
         }
         if(!p) { HALT("memory allocation failed! Wanted size = " <<Mnew*sizeT <<"bytes"); }
@@ -324,7 +339,8 @@ template<class T> void Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
     } else {
       if(p) {
         if(memMove==1){
-          free(p);
+          if(!isSmall()) memFree(p, isArena);
+          isArena=false;
         }else{
           delete[] p;
         }
@@ -346,13 +362,14 @@ template<class T> void Array<T>::freeMEM() {
   if(M) {
     globalMemoryTotal -= M*sizeT;
     if(memMove==1){
-      free(p);
+      if(!isSmall()) memFree(p, isArena);
     }else{
       delete[] p;
     }
     p=0;
     M=0;
   }
+  isArena=false;
 #endif
   if(d && d!=&d0) { delete[] d; d=NULL; }
   p=NULL;
@@ -1312,6 +1329,9 @@ template<class T> void Array<T>::takeOver(Array<T>& a) {
   memMove=a.memMove;
   N=a.N; nd=a.nd; d0=a.d0; d1=a.d1; d2=a.d2;
   p=a.p; M=a.M;
+  isArena=a.isArena;
+  if(a.isSmall()) { p=(T*)smallMem; memmove(p, a.p, sizeT*N); } //inline memory can't be taken over, only copied
+  else if(isArena) p=(T*)memRehome(p, sizeT*N, sizeT*M, isArena, this);
   special=a.special;
 #if 0 //a remains reference on this
   a.isReference=true;
@@ -1322,6 +1342,7 @@ template<class T> void Array<T>::takeOver(Array<T>& a) {
   if(a.d && a.d!=&a.d0) { delete[] a.d; a.d=NULL; }
   a.special=0;
   a.isReference=false;
+  a.isArena=false;
 #endif
 }
 
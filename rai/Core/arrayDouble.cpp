@@ -28,6 +28,304 @@
 //#define RAI_NO_VEC_IMPL
 //#endif
 
+//===========================================================================
+//
+// vectorized kernels for the elementary double loops
+//
+
+/* The reductions (sumOfSqr, scalarProduct, absMax, sumOfAbs, sumOfPos) and the
+   dense update operators (+=, -=, *=) call these kernels for arrays of at least
+   ARRAY_simdMin elements. Each kernel exists as a scalar fallback and, on x86
+   with gcc/clang, as AVX2 and AVX-512 versions compiled with target attributes;
+   the version is selected once at runtime via cpuid (see rai::setSimdLevel).
+   The vectorized reductions accumulate in several lanes and therefore differ
+   from the scalar ones by rounding only. absMax returns NaN if any entry is NaN
+   in all versions (max_pd drops NaN operands, so the vectorized ones collect
+   an unordered-compare mask alongside), so that convergence checks like
+   absMax(dx)<tol fail on NaN. */
+
+#define ARRAY_simdMin 16
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(RAI_NO_VEC_IMPL)
+#  define RAI_SIMD_X86
+#  include <immintrin.h>
+#endif
+
+namespace {
+
+struct SimdKernels {
+  double (*sumOfSqr)(const double* x, uint n);
+  double (*dot)(const double* x, const double* y, uint n);
+  double (*absMax)(const double* x, uint n);
+  double (*sumOfAbs)(const double* x, uint n);
+  double (*sumOfPos)(const double* x, uint n);
+  void (*add)(double* x, const double* y, uint n);
+  void (*sub)(double* x, const double* y, uint n);
+  void (*mul)(double* x, const double* y, uint n);
+  void (*scale)(double* x, double s, uint n);
+};
+
+//-- scalar fallback (the original loops)
+
+double scalar_sumOfSqr(const double* x, uint n) { double t=0.; for(uint i=0; i<n; i++) t+=x[i]*x[i]; return t; }
+double scalar_dot(const double* x, const double* y, uint n) { double t=0.; for(uint i=0; i<n; i++) t+=x[i]*y[i]; return t; }
+double scalar_absMax(const double* x, uint n) { double m=0.; for(uint i=0; i<n; i++) { double a=std::fabs(x[i]); if(a>m || a!=a) m=a; if(m!=m) break; } return m; }
+double scalar_sumOfAbs(const double* x, uint n) { double t=0.; for(uint i=0; i<n; i++) t+=std::fabs(x[i]); return t; }
+double scalar_sumOfPos(const double* x, uint n) { double t=0.; for(uint i=0; i<n; i++) if(x[i]>0.) t+=x[i]; return t; }
+void scalar_add(double* x, const double* y, uint n) { for(uint i=0; i<n; i++) x[i]+=y[i]; }
+void scalar_sub(double* x, const double* y, uint n) { for(uint i=0; i<n; i++) x[i]-=y[i]; }
+void scalar_mul(double* x, const double* y, uint n) { for(uint i=0; i<n; i++) x[i]*=y[i]; }
+void scalar_scale(double* x, double s, uint n) { for(uint i=0; i<n; i++) x[i]*=s; }
+
+const SimdKernels scalarKernels = { scalar_sumOfSqr, scalar_dot, scalar_absMax, scalar_sumOfAbs, scalar_sumOfPos,
+                                    scalar_add, scalar_sub, scalar_mul, scalar_scale };
+
+#ifdef RAI_SIMD_X86
+
+//-- AVX2: 4 doubles per register, two independent accumulators
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+AVX2 inline double avx2_hsum(__m256d v) {
+  __m128d lo=_mm256_castpd256_pd128(v), hi=_mm256_extractf128_pd(v, 1);
+  lo=_mm_add_pd(lo, hi);
+  return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+AVX2 inline double avx2_hmax(__m256d v) {
+  __m128d lo=_mm256_castpd256_pd128(v), hi=_mm256_extractf128_pd(v, 1);
+  lo=_mm_max_pd(lo, hi);
+  return _mm_cvtsd_f64(_mm_max_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+AVX2 double avx2_sumOfSqr(const double* x, uint n) {
+  __m256d s0=_mm256_setzero_pd(), s1=_mm256_setzero_pd();
+  uint i=0;
+  for(; i+8<=n; i+=8) {
+    __m256d a=_mm256_loadu_pd(x+i), b=_mm256_loadu_pd(x+i+4);
+    s0=_mm256_fmadd_pd(a, a, s0);
+    s1=_mm256_fmadd_pd(b, b, s1);
+  }
+  double t=avx2_hsum(_mm256_add_pd(s0, s1));
+  for(; i<n; i++) t+=x[i]*x[i];
+  return t;
+}
+AVX2 double avx2_dot(const double* x, const double* y, uint n) {
+  __m256d s0=_mm256_setzero_pd(), s1=_mm256_setzero_pd();
+  uint i=0;
+  for(; i+8<=n; i+=8) {
+    s0=_mm256_fmadd_pd(_mm256_loadu_pd(x+i), _mm256_loadu_pd(y+i), s0);
+    s1=_mm256_fmadd_pd(_mm256_loadu_pd(x+i+4), _mm256_loadu_pd(y+i+4), s1);
+  }
+  double t=avx2_hsum(_mm256_add_pd(s0, s1));
+  for(; i<n; i++) t+=x[i]*y[i];
+  return t;
+}
+AVX2 double avx2_absMax(const double* x, uint n) {
+  const __m256d sign=_mm256_set1_pd(-0.);
+  __m256d m0=_mm256_setzero_pd(), m1=_mm256_setzero_pd(), nan=_mm256_setzero_pd();
+  uint i=0;
+  for(; i+8<=n; i+=8) {
+    __m256d a0=_mm256_loadu_pd(x+i), a1=_mm256_loadu_pd(x+i+4);
+    nan=_mm256_or_pd(nan, _mm256_cmp_pd(a0, a1, _CMP_UNORD_Q)); //set where a0 or a1 is NaN
+    m0=_mm256_max_pd(_mm256_andnot_pd(sign, a0), m0);
+    m1=_mm256_max_pd(_mm256_andnot_pd(sign, a1), m1);
+  }
+  if(_mm256_movemask_pd(nan)) return NAN;
+  double m=avx2_hmax(_mm256_max_pd(m0, m1));
+  double t=scalar_absMax(x+i, n-i);
+  return (t>m || t!=t) ? t : m;
+}
+AVX2 double avx2_sumOfAbs(const double* x, uint n) {
+  const __m256d sign=_mm256_set1_pd(-0.);
+  __m256d s0=_mm256_setzero_pd(), s1=_mm256_setzero_pd();
+  uint i=0;
+  for(; i+8<=n; i+=8) {
+    s0=_mm256_add_pd(s0, _mm256_andnot_pd(sign, _mm256_loadu_pd(x+i)));
+    s1=_mm256_add_pd(s1, _mm256_andnot_pd(sign, _mm256_loadu_pd(x+i+4)));
+  }
+  double t=avx2_hsum(_mm256_add_pd(s0, s1));
+  for(; i<n; i++) t+=std::fabs(x[i]);
+  return t;
+}
+AVX2 double avx2_sumOfPos(const double* x, uint n) {
+  const __m256d zero=_mm256_setzero_pd();
+  __m256d s0=zero, s1=zero;
+  uint i=0;
+  for(; i+8<=n; i+=8) {
+    s0=_mm256_add_pd(s0, _mm256_max_pd(zero, _mm256_loadu_pd(x+i)));
+    s1=_mm256_add_pd(s1, _mm256_max_pd(zero, _mm256_loadu_pd(x+i+4)));
+  }
+  double t=avx2_hsum(_mm256_add_pd(s0, s1));
+  for(; i<n; i++) if(x[i]>0.) t+=x[i];
+  return t;
+}
+AVX2 void avx2_add(double* x, const double* y, uint n) {
+  uint i=0;
+  for(; i+4<=n; i+=4) _mm256_storeu_pd(x+i, _mm256_add_pd(_mm256_loadu_pd(x+i), _mm256_loadu_pd(y+i)));
+  for(; i<n; i++) x[i]+=y[i];
+}
+AVX2 void avx2_sub(double* x, const double* y, uint n) {
+  uint i=0;
+  for(; i+4<=n; i+=4) _mm256_storeu_pd(x+i, _mm256_sub_pd(_mm256_loadu_pd(x+i), _mm256_loadu_pd(y+i)));
+  for(; i<n; i++) x[i]-=y[i];
+}
+AVX2 void avx2_mul(double* x, const double* y, uint n) {
+  uint i=0;
+  for(; i+4<=n; i+=4) _mm256_storeu_pd(x+i, _mm256_mul_pd(_mm256_loadu_pd(x+i), _mm256_loadu_pd(y+i)));
+  for(; i<n; i++) x[i]*=y[i];
+}
+AVX2 void avx2_scale(double* x, double s, uint n) {
+  const __m256d sv=_mm256_set1_pd(s);
+  uint i=0;
+  for(; i+4<=n; i+=4) _mm256_storeu_pd(x+i, _mm256_mul_pd(_mm256_loadu_pd(x+i), sv));
+  for(; i<n; i++) x[i]*=s;
+}
+
+#undef AVX2
+
+const SimdKernels avx2Kernels = { avx2_sumOfSqr, avx2_dot, avx2_absMax, avx2_sumOfAbs, avx2_sumOfPos,
+                                  avx2_add, avx2_sub, avx2_mul, avx2_scale };
+
+//-- AVX-512: 8 doubles per register; tails are handled with masked loads
+
+//gcc's avx512 headers use _mm512_undefined_pd() in the reductions, which triggers false warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define AVX512 __attribute__((target("avx512f")))
+
+AVX512 inline __mmask8 avx512_tail(uint r) { return (__mmask8)((1u<<r)-1u); }
+
+AVX512 double avx512_sumOfSqr(const double* x, uint n) {
+  __m512d s0=_mm512_setzero_pd(), s1=_mm512_setzero_pd();
+  uint i=0;
+  for(; i+16<=n; i+=16) {
+    __m512d a=_mm512_loadu_pd(x+i), b=_mm512_loadu_pd(x+i+8);
+    s0=_mm512_fmadd_pd(a, a, s0);
+    s1=_mm512_fmadd_pd(b, b, s1);
+  }
+  for(; i<n; i+=8) {
+    __m512d a=_mm512_maskz_loadu_pd(n-i>=8 ? 0xff : avx512_tail(n-i), x+i);
+    s0=_mm512_fmadd_pd(a, a, s0);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+AVX512 double avx512_dot(const double* x, const double* y, uint n) {
+  __m512d s0=_mm512_setzero_pd(), s1=_mm512_setzero_pd();
+  uint i=0;
+  for(; i+16<=n; i+=16) {
+    s0=_mm512_fmadd_pd(_mm512_loadu_pd(x+i), _mm512_loadu_pd(y+i), s0);
+    s1=_mm512_fmadd_pd(_mm512_loadu_pd(x+i+8), _mm512_loadu_pd(y+i+8), s1);
+  }
+  for(; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    s0=_mm512_fmadd_pd(_mm512_maskz_loadu_pd(k, x+i), _mm512_maskz_loadu_pd(k, y+i), s0);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+AVX512 double avx512_absMax(const double* x, uint n) {
+  __m512d m=_mm512_setzero_pd();
+  __mmask8 nan=0;
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    __m512d a=_mm512_maskz_loadu_pd(k, x+i);
+    nan |= _mm512_cmp_pd_mask(a, a, _CMP_UNORD_Q);
+    m=_mm512_max_pd(_mm512_abs_pd(a), m);
+  }
+  if(nan) return NAN;
+  return _mm512_reduce_max_pd(m);
+}
+AVX512 double avx512_sumOfAbs(const double* x, uint n) {
+  __m512d s=_mm512_setzero_pd();
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    s=_mm512_add_pd(s, _mm512_abs_pd(_mm512_maskz_loadu_pd(k, x+i)));
+  }
+  return _mm512_reduce_add_pd(s);
+}
+AVX512 double avx512_sumOfPos(const double* x, uint n) {
+  const __m512d zero=_mm512_setzero_pd();
+  __m512d s=zero;
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    s=_mm512_add_pd(s, _mm512_max_pd(zero, _mm512_maskz_loadu_pd(k, x+i)));
+  }
+  return _mm512_reduce_add_pd(s);
+}
+AVX512 void avx512_add(double* x, const double* y, uint n) {
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    _mm512_mask_storeu_pd(x+i, k, _mm512_add_pd(_mm512_maskz_loadu_pd(k, x+i), _mm512_maskz_loadu_pd(k, y+i)));
+  }
+}
+AVX512 void avx512_sub(double* x, const double* y, uint n) {
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    _mm512_mask_storeu_pd(x+i, k, _mm512_sub_pd(_mm512_maskz_loadu_pd(k, x+i), _mm512_maskz_loadu_pd(k, y+i)));
+  }
+}
+AVX512 void avx512_mul(double* x, const double* y, uint n) {
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    _mm512_mask_storeu_pd(x+i, k, _mm512_mul_pd(_mm512_maskz_loadu_pd(k, x+i), _mm512_maskz_loadu_pd(k, y+i)));
+  }
+}
+AVX512 void avx512_scale(double* x, double s, uint n) {
+  const __m512d sv=_mm512_set1_pd(s);
+  for(uint i=0; i<n; i+=8) {
+    __mmask8 k = n-i>=8 ? 0xff : avx512_tail(n-i);
+    _mm512_mask_storeu_pd(x+i, k, _mm512_mul_pd(_mm512_maskz_loadu_pd(k, x+i), sv));
+  }
+}
+
+#undef AVX512
+#pragma GCC diagnostic pop
+
+const SimdKernels avx512Kernels = { avx512_sumOfSqr, avx512_dot, avx512_absMax, avx512_sumOfAbs, avx512_sumOfPos,
+                                    avx512_add, avx512_sub, avx512_mul, avx512_scale };
+
+#endif //RAI_SIMD_X86
+
+int cpuSimdLevel() {
+#ifdef RAI_SIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")) return 2;
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return 1;
+#endif
+  return 0;
+}
+
+const SimdKernels* kernelsFor(int level) {
+#ifdef RAI_SIMD_X86
+  if(level>=2) return &avx512Kernels;
+  if(level==1) return &avx2Kernels;
+#endif
+  return &scalarKernels;
+}
+
+//constant-initialized, so that static initializers of other units see valid kernels
+int simdLevel = 0;
+const SimdKernels* simd = &scalarKernels;
+
+} //namespace
+
+namespace rai {
+
+int getSimdLevel() { return simdLevel; }
+
+int setSimdLevel(int level) {
+  int cpu = cpuSimdLevel();
+  if(level<0 || level>cpu) level=cpu;
+  simdLevel = level;
+  simd = kernelsFor(level);
+  return level;
+}
+
+} //namespace
+
+static int simdInit = rai::setSimdLevel(-1);
+
 //===========================================================================
 //
 // Array class
@@ -677,10 +975,8 @@ double absMin(const arr& x) {
 
 /// get absolute maximum (using fabs)
 double absMax(const arr& x) {
-  if(!x.N) return 0;
-  double m(std::fabs(x.p[0]));
-  for(uint i=x.N; --i;) if(std::fabs(x.p[i])>m) m=std::fabs(x.p[i]);
-  return m;
+  if(x.N>=ARRAY_simdMin) return simd->absMax(x.p, x.N);
+  return scalar_absMax(x.p, x.N);
 }
 
 uint argmin(const arr& x) { CHECK_GE(x.N, 1, ""); uint m=0; for(uint i=x.N; --i;) if(x.p[i]<x.p[m]) m=i; return m; }
@@ -785,6 +1081,7 @@ arr sum(const arr& v, uint d) {
 
 /// \f$\sum_i |x_i|\f$
 double sumOfAbs(const arr& v) {
+  if(v.N>=ARRAY_simdMin) return simd->sumOfAbs(v.p, v.N);
   double t(0);
   for(uint i=v.N; i--; t+=std::fabs(v.p[i])) {};
   return t;
@@ -792,6 +1089,7 @@ double sumOfAbs(const arr& v) {
 
 /// \f$\sum_i |x_i|_+\f$
 double sumOfPos(const arr& v) {
+  if(v.N>=ARRAY_simdMin) return simd->sumOfPos(v.p, v.N);
   double t(0);
   for(uint i=0;i<v.N;i++) if(v.p[i]>0) t+=v.p[i];
   return t;
@@ -799,6 +1097,7 @@ double sumOfPos(const arr& v) {
 
 /// \f$\sum_i x_i^2\f$
 double sumOfSqr(const arr& v) {
+  if(v.N>=ARRAY_simdMin) return simd->sumOfSqr(v.p, v.N);
   double t(0);
   for(uint i=v.N; i--; t+=v.p[i]*v.p[i]) {};
   return t;
@@ -1135,8 +1434,11 @@ void op_indexWiseProduct(arr& x, const arr& y, const arr& z) {
   if(y.dim() == z.dim()) { //matrix x matrix -> element-wise
 //    HALT("THIS IS AMBIGUOUS!");
     x = y;
-    double* xp=x.p, *xstop=x.p+x.N, *zp=z.p;
-    for(; xp!=xstop; xp++, zp++) *xp *= *zp;
+    if(x.N>=ARRAY_simdMin) simd->mul(x.p, z.p, x.N);
+    else{
+      double* xp=x.p, *xstop=x.p+x.N, *zp=z.p;
+      for(; xp!=xstop; xp++, zp++) *xp *= *zp;
+    }
     if(y.jac || z.jac){
       NIY;
       //if(!y.jac && z.jac) x.J() = y % (*z.jac);
@@ -1181,6 +1483,7 @@ double scalarProduct(const arr& v, const arr& w) {
   if(!v.special && !w.special) {
     CHECK_EQ(v.N, w.N,
              "scalar product on different array dimensions (" <<v.N <<", " <<w.N <<")");
+    if(v.N>=ARRAY_simdMin) return simd->dot(v.p, w.p, v.N);
     for(uint i=v.N; i--; t+=v.p[i]*w.p[i]);
   } else {
     if(isSparseVector(v) && isSparseVector(w)) {
@@ -1812,6 +2115,41 @@ arr operator/(const arr& y, const arr& z) { arr x(y); x/=z; return x; }
 /// contatenation of two arrays
 arr operator, (const arr& y, const arr& z) { arr x(y); x.append(z); return x; }
 
+/* rvalue versions: when an operand is a temporary that owns its memory, the
+   result is computed in place and the temporary's buffer is handed on. A chain
+   like a + 2.*b - c/3. thereby needs a single allocation instead of four. The
+   update operators take care of the jacobians exactly as in the copying
+   versions. References (e.g., x[i]) are never modified: they fall back to a copy. */
+
+static bool isRecyclable(const arr& x) { return !x.isReference && !x.special; }
+
+arr operator+(arr&& y, const arr& z) { if(!isRecyclable(y)) return (const arr&)y + z;  y+=z; return std::move(y); }
+arr operator+(const arr& y, arr&& z) { if(!isRecyclable(z)) return y + (const arr&)z;  z+=y; z.reshapeAs(y); return std::move(z); }
+arr operator+(arr&& y, arr&& z) { return std::move(y) + (const arr&)z; }
+arr operator+(double y, arr&& z) {     if(!isRecyclable(z)) return y + (const arr&)z;  z+=y; return std::move(z); }
+arr operator+(arr&& y, double z) {     if(!isRecyclable(y)) return (const arr&)y + z;  y+=z; return std::move(y); }
+
+arr operator-(arr&& y, const arr& z) { if(!isRecyclable(y)) return (const arr&)y - z;  y-=z; return std::move(y); }
+arr operator-(arr&& y, double z) {     if(!isRecyclable(y)) return (const arr&)y - z;  y-=z; return std::move(y); }
+arr operator-(arr&& y) {
+  if(!isRecyclable(y)) return -(const arr&)y;
+  double* xp=y.p, *xstop=xp+y.N;
+  for(; xp!=xstop; xp++) *xp = - (*xp);
+  if(y.jac) *y.jac = -std::move(*y.jac);
+  return std::move(y);
+}
+
+arr operator*(arr&& y, double z) {     if(!isRecyclable(y)) return (const arr&)y * z;  y*=z; return std::move(y); }
+arr operator*(double y, arr&& z) {     if(!isRecyclable(z)) return y * (const arr&)z;  z*=y; return std::move(z); }
+arr operator/(arr&& y, double z) {     if(!isRecyclable(y)) return (const arr&)y / z;  y/=z; return std::move(y); }
+
+arr operator%(arr&& y, const arr& z) {
+  //only the plain elem-wise case; jacobians and broadcasting go through op_indexWiseProduct
+  if(!isRecyclable(y) || z.special || y.jac || z.jac || y.dim()!=z.dim()) return (const arr&)y % z;
+  y*=z;
+  return std::move(y);
+}
+
 /// x.append(y)
 arr& operator<<(arr& x, const double& y) { x.append(y); return x; }
 
@@ -1831,6 +2169,21 @@ arr& operator<<(arr& x, const arr& y) { x.append(y); return x; }
     const double *yp=y.p;              \
     for(; xp!=xstop; xp++, yp++) *xp op *yp;
 
+//same, but dispatching to a vectorized kernel for larger arrays
+#define UpdateOperator_MM_simd( op, kernel )        \
+    if(isNoArr(x)){ return x; } \
+    if(isSparseMatrix(x) && isSparseMatrix(y)){ x.sparse() op y.sparse(); return x; }  \
+    if(isRowShifted(x) && isRowShifted(y)){ x.rowShifted() op y.rowShifted(); return x; }  \
+    CHECK(!isSpecial(x), "");  \
+    CHECK(!isSpecial(y), "");  \
+    CHECK_EQ(x.N, y.N, "update operator on different array dimensions (" <<x.N <<", " <<y.N <<")"); \
+    if(x.N>=ARRAY_simdMin) simd->kernel(x.p, y.p, x.N); \
+    else{ \
+      double *xp=x.p, *xstop=xp+x.N;              \
+      const double *yp=y.p;              \
+      for(; xp!=xstop; xp++, yp++) *xp op *yp; \
+    }
+
 //core for matrix-scalar update
 #define UpdateOperator_MS( op ) \
   if(isNoArr(x)){ return x; } \
@@ -1840,9 +2193,21 @@ arr& operator<<(arr& x, const arr& y) { x.append(y); return x; }
   double *xp=x.p, *xstop=xp+x.N;              \
   for(; xp!=xstop; xp++) *xp op y;
 
+//same, but dispatching to a vectorized kernel for larger arrays
+#define UpdateOperator_MS_simd( op, kernel ) \
+  if(isNoArr(x)){ return x; } \
+  if(isSparseMatrix(x)){ x.sparse() op y; return x; }  \
+  if(isRowShifted(x)){ x.rowShifted() op y; return x; }  \
+  CHECK(!isSpecial(x), "");  \
+  if(x.N>=ARRAY_simdMin) simd->kernel(x.p, y, x.N); \
+  else{ \
+    double *xp=x.p, *xstop=xp+x.N;              \
+    for(; xp!=xstop; xp++) *xp op y; \
+  }
+
 
 arr& operator+=(arr& x, const arr& y){
-  UpdateOperator_MM(+=);
+  UpdateOperator_MM_simd(+=, add);
   if(y.jac){
     if(x.jac) *x.jac += *y.jac;
     else x.J() = *y.jac;
@@ -1854,7 +2219,7 @@ arr& operator+=(arr& x, double y){
   return x;
 }
 arr& operator+=(arr&& x, const arr& y){
-  UpdateOperator_MM(+=);
+  UpdateOperator_MM_simd(+=, add);
   if(y.jac){
     if(x.jac) *x.jac += *y.jac;
     else x.J() = *y.jac;
@@ -1867,7 +2232,7 @@ arr& operator+=(arr&& x, double y){
 }
 
 arr& operator-=(arr& x, const arr& y){
-  UpdateOperator_MM(-=);
+  UpdateOperator_MM_simd(-=, sub);
   if(y.jac){
     if(x.jac) *x.jac -= *y.jac;
     else x.J() = -(*y.jac);
@@ -1879,7 +2244,7 @@ arr& operator-=(arr& x, double y){
   return x;
 }
   arr& operator-=(arr&& x, const arr& y){
-    UpdateOperator_MM(-=);
+    UpdateOperator_MM_simd(-=, sub);
     if(y.jac){
       if(x.jac) *x.jac -= *y.jac;
       else x.J() = -(*y.jac);
@@ -1899,12 +2264,12 @@ arr& operator*=(arr& x, const arr& y){
     else if(!x.jac && y.jac) x.J() = x % (*y.jac);
     else{ *x.jac = y.noJ() % (*x.jac); *x.jac += x.noJ() % (*y.jac); }
   }
-  UpdateOperator_MM(*=);
+  UpdateOperator_MM_simd(*=, mul);
   return x;
 }
 arr& operator*=(arr& x, double y){
   if(x.jac) *x.jac *= y;
-  UpdateOperator_MS(*=);
+  UpdateOperator_MS_simd(*=, scale);
   return x;
 }
   arr& operator*=(arr&& x, const arr& y){
@@ -1914,12 +2279,12 @@ arr& operator*=(arr& x, double y){
       else if(!x.jac && y.jac) x.J() = x.noJ() % (*y.jac);
       else NIY;
     }
-    UpdateOperator_MM(*=);
+    UpdateOperator_MM_simd(*=, mul);
     return x;
   }
   arr& operator*=(arr&& x, double y){
     if(x.jac) *x.jac *= y;
-    UpdateOperator_MS(*=);
+    UpdateOperator_MS_simd(*=, scale);
     return x;
   }
 
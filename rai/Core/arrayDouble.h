@@ -217,6 +217,20 @@ arr operator/(const arr& y, double z);
 arr operator/(const arr& y, const arr& z); //element-wise devision
 arr operator, (const arr& y, const arr& z); //concat
 
+//versions that compute in place in a temporary operand (unless it is a reference), saving allocations in chains
+arr operator+(arr&& y, const arr& z);
+arr operator+(const arr& y, arr&& z);
+arr operator+(arr&& y, arr&& z);
+arr operator+(double y, arr&& z);
+arr operator+(arr&& y, double z);
+arr operator-(arr&& y, const arr& z);
+arr operator-(arr&& y, double z);
+arr operator-(arr&& y);
+arr operator*(arr&& y, double z);
+arr operator*(double y, arr&& z);
+arr operator/(arr&& y, double z);
+arr operator%(arr&& y, const arr& z);
+
 arr& operator<<(arr& x, const double& y); //append
 arr& operator<<(arr& x, const arr& y); //append
 
@@ -415,6 +429,13 @@ void addDiag(arr& A, double d);
 namespace rai {
 /// use this to turn on Lapack routines [default true if RAI_LAPACK is defined]
 extern bool useLapack;
+/// number of threads for sparse At_A and At_x [default 0: the OpenMP default]; results do not depend on it
+extern uint sparseNumThreads;
+/// SIMD kernels used by sumOfSqr, scalarProduct, absMax, sumOfAbs, sumOfPos and the dense +=, -=, *= operators:
+/// 0=scalar, 1=AVX2, 2=AVX-512 [default: best supported by the cpu]
+int getSimdLevel();
+/// select SIMD kernels (clamped to what the cpu supports; -1 for the best); returns the level in use
+int setSimdLevel(int level);
 }
 
 uint svd(arr& U, arr& d, arr& V, const arr& A, bool sort2Dpoints=true);
@@ -626,6 +647,21 @@ arr lapack_Ainv_b_symPosDef_givenCholesky(const arr& U, const arr& b);
 arr lapack_Ainv_b_triangular(const arr& L, const arr& b);
 arr eigen_Ainv_b(const arr& A, const arr& b);
 
+namespace rai {
+/// sparse symmetric solver that persists its factorization: the fill-reducing ordering & symbolic analysis
+/// are only recomputed when the sparsity pattern of A changes; otherwise only a numeric refactorization is done
+struct SparseSymSolver {
+  uint numAnalyze=0, numFactorize=0;
+
+  SparseSymSolver();
+  ~SparseSymSolver();
+  arr solve(const arr& A, const arr& b);
+  void clear();
+private:
+  std::unique_ptr<struct sSparseSymSolver> self;
+};
+}
+
 //===========================================================================
 /// @}
 /// @name special matrices & packings
@@ -711,9 +747,13 @@ struct SparseVector: SpecialArray {
 
 struct SparseMatrix : SpecialArray {
   arr& Z;      ///< references the array itself, which linearly stores numbers
-  intA elems;  ///< for every non-zero (in memory order), the (row,col) index tuple
-  uintAA cols; ///< for every column, for every non-zero the (row,memory) index tuple
-  uintAA rows; ///< for every row   , for every non-zero the (column,memory) index tuple
+  intA elems;  ///< for every non-zero (in memory order), the (row,col) index tuple -- code writing elems directly (not via addEntry, resize, etc) must call clearRowsCols()
+  //compressed indices, built by setupRowsCols() and cleared whenever the sparsity pattern changes
+  intA rowPtr, rowCol; ///< CSR: the non-zeros of row i are rowPtr(i),..,rowPtr(i+1)-1; for each its column (ascending within a row)
+  intA colPtr, colRow; ///< CSC: the non-zeros of column j are colPtr(j),..,colPtr(j+1)-1; for each its row (ascending within a column)
+  uintA rowMem, colMem; ///< CSR/CSC: for each compressed non-zero its memory index in Z
+  bool isCSC=false;     ///< true if the memory Z itself is in CSC order without duplicates (colMem is the identity)
+  uint rowsColsN=0;     ///< elems.d0 when the index was built (to detect stale indices)
 
   SparseMatrix(arr& _Z);
   SparseMatrix(arr& _Z, const SparseMatrix& s);
@@ -726,6 +766,10 @@ struct SparseMatrix : SpecialArray {
   //construction
   void setFromDense(const arr& X);
   void setupRowsCols();
+  void clearRowsCols();
+  bool hasRowsCols() const { return colPtr.N; }
+  void ensureRowsCols() { if(!hasRowsCols()) setupRowsCols(); else checkRowsCols(); }
+  void checkRowsCols() const;
   //manipulations
   SparseMatrix& resize(uint d0, uint d1, uint n);
   void resizeCopy(uint d0, uint d1, uint n);
@@ -769,8 +813,92 @@ UpdateOperator(/=)
 UpdateOperator(%=)
 #undef UpdateOperator
 
+//===========================================================================
+//
+// fixed-size arrays
+//
+
+/** @brief double array with compile-time dimensions (D1=0: vector of size D0), stored in place.
+    No heap allocation, no runtime dimension checks, and all loops have constant trip counts so
+    that the compiler unrolls and vectorizes them. view() gives an arr referring to the same memory,
+    for everything that expects an arr. */
+template<uint D0, uint D1=0> struct FixedArr {
+  static constexpr uint d0=D0, d1=D1, N=D0*(D1?D1:1);
+  double p[N];
+
+  FixedArr() {} //uninitialized
+  explicit FixedArr(const double* x) { for(uint i=0; i<N; i++) p[i]=x[i]; }
+  explicit FixedArr(const arr& x) { CHECK_EQ(x.N, N, "wrong size"); for(uint i=0; i<N; i++) p[i]=x.p[i]; }
+  FixedArr(std::initializer_list<double> values) { CHECK_EQ(values.size(), N, "wrong size"); uint i=0; for(double v:values) p[i++]=v; }
+
+  FixedArr& setZero() { for(uint i=0; i<N; i++) p[i]=0.; return *this; }
+
+  double& operator()(uint i) { return p[i]; }
+  double operator()(uint i) const { return p[i]; }
+  double& operator()(uint i, uint j) { static_assert(D1, "not a matrix"); return p[i*D1+j]; }
+  double operator()(uint i, uint j) const { static_assert(D1, "not a matrix"); return p[i*D1+j]; }
+
+  /// arr referring to this memory (valid only as long as this lives)
+  arr view() const { arr x; x.referTo(p, N); if(D1) x.reshape(D0, D1); return x; }
+  /// arr copy
+  arr copy() const { arr x(p, N, false); if(D1) x.reshape(D0, D1); return x; }
+
+  FixedArr& operator+=(const FixedArr& b) { for(uint i=0; i<N; i++) p[i]+=b.p[i]; return *this; }
+  FixedArr& operator-=(const FixedArr& b) { for(uint i=0; i<N; i++) p[i]-=b.p[i]; return *this; }
+  FixedArr& operator*=(double s) { for(uint i=0; i<N; i++) p[i]*=s; return *this; }
+  FixedArr& operator/=(double s) { for(uint i=0; i<N; i++) p[i]/=s; return *this; }
+};
+
+/// matrix-vector product
+template<uint D0, uint D1> FixedArr<D0> operator*(const FixedArr<D0, D1>& A, const FixedArr<D1>& x) {
+  static_assert(D1, "not a matrix");
+  FixedArr<D0> y;
+  for(uint i=0; i<D0; i++) { double s=0.; for(uint k=0; k<D1; k++) s += A.p[i*D1+k]*x.p[k]; y.p[i]=s; }
+  return y;
+}
+
+/// matrix-matrix product
+template<uint D0, uint D1, uint D2> FixedArr<D0, D2> operator*(const FixedArr<D0, D1>& A, const FixedArr<D1, D2>& B) {
+  static_assert(D1 && D2, "not a matrix");
+  FixedArr<D0, D2> C;
+  C.setZero();
+  for(uint i=0; i<D0; i++) for(uint k=0; k<D1; k++) {
+    double a=A.p[i*D1+k];
+    for(uint j=0; j<D2; j++) C.p[i*D2+j] += a*B.p[k*D2+j];
+  }
+  return C;
+}
+
 }//namespace rai
 
+/// cross product of 3-vectors
+inline rai::FixedArr<3> crossProduct(const rai::FixedArr<3>& y, const rai::FixedArr<3>& z) {
+  return { y.p[1]*z.p[2]-y.p[2]*z.p[1], y.p[2]*z.p[0]-y.p[0]*z.p[2], y.p[0]*z.p[1]-y.p[1]*z.p[0] };
+}
+
+/// every COLUMN of Y is cross-product'd with z (as crossProduct(arr, arr))
+template<uint D1> rai::FixedArr<3, D1> crossProduct(const rai::FixedArr<3, D1>& Y, const rai::FixedArr<3>& z) {
+  rai::FixedArr<3, D1> X;
+  for(uint j=0; j<D1; j++) {
+    double y0=Y.p[j], y1=Y.p[D1+j], y2=Y.p[2*D1+j];
+    X.p[j]      = y1*z.p[2]-y2*z.p[1];
+    X.p[D1+j]   = y2*z.p[0]-y0*z.p[2];
+    X.p[2*D1+j] = y0*z.p[1]-y1*z.p[0];
+  }
+  return X;
+}
+
+/// write B into the matrix J at (lo0, lo1); J may be dense or sparse
+template<uint D0, uint D1> void setMatrixBlock(arr& J, const rai::FixedArr<D0, D1>& B, uint lo0, uint lo1) {
+  constexpr uint B1 = D1?D1:1;
+  if(!J.special) {
+    CHECK(J.nd==2 && lo0+D0<=J.d0 && lo1+B1<=J.d1, "");
+    for(uint i=0; i<D0; i++) for(uint j=0; j<B1; j++) J.p[(lo0+i)*J.d1+lo1+j] = B.p[i*B1+j];
+  } else {
+    for(uint i=0; i<D0; i++) for(uint j=0; j<B1; j++) J.elem(lo0+i, lo1+j) = B.p[i*B1+j];
+  }
+}
+
 //===========================================================================
 //
 // conv with Eigen
@@ -779,9 +907,13 @@ UpdateOperator(%=)
 #ifdef RAI_EIGEN
 
 #include <Eigen/Dense>
+#include <Eigen/SparseCore>
 
 arr conv_eigen2arr(const Eigen::MatrixXd& in);
 Eigen::MatrixXd conv_arr2eigen(const arr& in);
+Eigen::SparseMatrix<double> conv_sparseArr2sparseEigen(const rai::SparseMatrix& S);
+Eigen::Map<const Eigen::SparseMatrix<double>> conv_sparseArr2sparseEigenView(const rai::SparseMatrix& S);
+arr conv_sparseEigen2sparseArr(Eigen::SparseMatrix<double>& E);
 
 #endif //RAI_EIGEN
 
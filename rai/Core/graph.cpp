@@ -10,6 +10,16 @@
 #include "util.ipp"
 
 #include <map>
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 #ifdef RAI_JSON
 #  include <jsoncpp/json/json.h>
@@ -77,13 +87,25 @@ Node::Node(const std::type_info& _type, Graph& _container, const char* _key, con
   CHECK(&container!=&NoGraph, "This is a NGraph (nullptr) -- don't do that anymore!");
   index=container.N;
   container.NodeL::append(this);
+  if(container.isKeyIndexed) container.keyIndex[key.p?key.p:""].append(this);
   if(_parents.N) for(Node* p: _parents) addParent(p);
 }
 
+/// remove n from the key index of its container
+static void keyIndexRemove(Node* n) {
+  if(!n->container.isKeyIndexed) return;
+  auto it = n->container.keyIndex.find(n->key.p?n->key.p:"");
+  if(it==n->container.keyIndex.end()) return;
+  NodeL& bucket = it->second;
+  if(bucket.N && bucket.elem(-1)==n) bucket.resizeCopy(bucket.N-1); else bucket.removeValue(n, false);
+  if(!bucket.N) n->container.keyIndex.erase(it);
+}
+
 Node::~Node() {
   if(container.isDoubleLinked) while(children.N) children.elem(-1)->removeParent(this);
   if(numChildren) LOG(-2) <<"It is not allowed to delete nodes that still have children";
   while(parents.N) removeParent(parents.elem(-1));
+  keyIndexRemove(this);
   if(this==container.elem(-1)) { //great: this is very efficient to remove without breaking indexing
     container.resizeCopy(container.N-1);
   } else {
@@ -118,6 +140,12 @@ void Node::swapParent(uint i, Node* p) {
   if(container.isDoubleLinked) parents(i)->children.append(this);
 }
 
+void Node::setKey(const char* _key) {
+  keyIndexRemove(this);
+  (String&)key = _key;
+  if(container.isKeyIndexed) container.keyIndex[key.p?key.p:""].append(this);
+}
+
 bool Node::matches(const char* _key) {
   if(key==_key) return true;
   return false;
@@ -288,11 +316,13 @@ void Graph::clear() {
   DEBUG(checkConsistency();)
   if(!isNodeOfGraph) { //this is not a subgraph; save to delete connections in batch -> faster
     NodeL all = getAllNodesRecursively();
+    keyIndex.clear();
     for(Node* n:all) {
       n->parents.clear();
       n->numChildren=0;
       n->children.clear();
-      n->key.clear();
+      ((String&)n->key).clear();
+      if(n->isGraph()) n->graph().keyIndex.clear();
     }
     DEBUG(checkConsistency();)
   }
@@ -338,10 +368,47 @@ void Graph::appendDict(const std::map<std::string, std::string>& dict) {
   }
 }
 
+/* The key index maps each key to its nodes in arbitrary order; the first match in
+   list order is the one with the lowest index. Keys only change via Node::setKey,
+   so a miss in the index is a miss in the graph. */
+
+const NodeL* Graph::findKeyBucket(const char* key) const {
+  auto it = keyIndex.find(key);
+  if(it==keyIndex.end()) return nullptr;
+  if(!isIndexed) ((Graph*)this)->index();
+  return &it->second;
+}
+
+void Graph::indexKeys() {
+  isKeyIndexed=true;
+  keyIndex.clear();
+  for(Node* n:*this) keyIndex[n->key.p?n->key.p:""].append(n);
+}
+
+/// first (in list order) node of the bucket matching the type (if given)
+static Node* firstOfBucket(const NodeL* bucket, const std::type_info* type) {
+  Node* ret=nullptr;
+  if(bucket) for(Node* n:*bucket) {
+    if(type && n->type!=*type) continue;
+    if(!ret || n->index<ret->index) ret=n;
+  }
+  return ret;
+}
+
+/// all nodes of the bucket matching the type (if given), in list order
+static NodeL allOfBucket(const NodeL* bucket, const std::type_info* type) {
+  NodeL ret;
+  if(bucket) for(Node* n:*bucket) if(!type || n->type==*type) ret.append(n);
+  if(ret.N>1) std::sort(ret.p, ret.p+ret.N, [](Node* a, Node* b){ return a->index<b->index; });
+  return ret;
+}
+
 Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
 //  for(uint i=N;i--;) if(elem(i)->matches(key)) return elem(i);
-  for(Node *n:(*this)) if(n->matches(key)) return n;
   Node* ret=nullptr;
+  if(key && isKeyIndexed) ret = firstOfBucket(findKeyBucket(key), nullptr);
+  else for(Node *n:(*this)) if(n->matches(key)) { ret=n; break; }
+  if(ret) return ret;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNode(key, true, false);
   if(ret) return ret;
   if(recurseDown){
@@ -354,8 +421,10 @@ Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
 }
 
 Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) return n;
   Node* ret=nullptr;
+  if(key && isKeyIndexed) ret = firstOfBucket(findKeyBucket(key), &type);
+  else for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) { ret=n; break; }
+  if(ret) return ret;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNodeOfType(type, key, true, false);
   if(ret) return ret;
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) {
@@ -367,7 +436,8 @@ Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool re
 
 NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
+  if(key && isKeyIndexed) ret = allOfBucket(findKeyBucket(key), nullptr);
+  else for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodes(key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodes(key, false, true));
   return ret;
@@ -375,7 +445,8 @@ NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const
 
 NodeL Graph::findNodesOfType(const std::type_info& type, const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) ret.append(n);
+  if(key && isKeyIndexed) ret = allOfBucket(findKeyBucket(key), &type);
+  else for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodesOfType(type, key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodesOfType(type, key, false, true));
   return ret;
@@ -532,6 +603,7 @@ void Graph::copy(const Graph& G, bool appendInsteadOfClear, bool enforceCopySubg
 
   //-- first delete existing nodes
   if(!appendInsteadOfClear) clear();
+  if(G.isKeyIndexed && !isKeyIndexed) indexKeys();
   uint indexOffset=N;
   NodeL newNodes;
 
@@ -593,51 +665,46 @@ void Graph::copy(const Graph& G, bool appendInsteadOfClear, bool enforceCopySubg
   DEBUG(G.checkConsistency());
 }
 
-void Graph::read(std::istream& is, bool parseInfo) {
-  uint Nbefore = N;
-  if(parseInfo) getParseInfo(nullptr).beg=is.tellg();
-  String namePrefix;
-  StringA tags;
-  for(;;) {
-    DEBUG(checkConsistency());
-    char c=peerNextChar(is, " \n\r\t,");
-    if(!is.good() || c=='}') { is.clear(); break; }
-    Node* n = readNode(is, tags, NULL, false, parseInfo);
-    if(!n) break;
-    if(n->key=="Parent" && n->isOfType<NodeL>()) {
-      NodeL& P = n->get<NodeL>();
-      Node *nn = n->container.isNodeOfGraph;
-      CHECK(nn,"can set 'Parent' only within a subgraph node");
-      for(Node *par:P) nn->addParent(par);
-      delete n; n=nullptr;
-    }else if(n->key=="Quit") {
-      delete n; n=nullptr;
-    }else if(n->key=="Include") {
-      uint Nbefore = N;
-      read(n->get<FileToken>().getIs(true), parseInfo);
-      if(namePrefix.N) { //prepend a naming prefix to all nodes just read
-        for(uint i=Nbefore; i<N; i++) elem(i)->key.prepend(namePrefix);
-        namePrefix.clear();
-      }
-      n->get<FileToken>().cd_start();
-      delete n; n=nullptr;
-    } else if(n->key=="Prefix") {
-      if(n->isOfType<String>()) {
-        namePrefix = n->get<String>();
-      } else if(n->isOfType<bool>() && !n->get<bool>()) {
-        namePrefix.clear();
-      } else LOG(-1) <<*n <<" is not a proper name prefix";
-      delete n; n=nullptr;
-    } else if(n->key=="ChDir") {
-      n->get<FileToken>().cd_file();
-    } else if(tags.N && tags(0)=="Delete") {
-//      n->key.remove(0);
-      NodeL dels = getNodes(n->key);
-      for(Node* d: dels) { delete d; d=nullptr; }
+/// interprets the special nodes Parent, Quit, Include, Prefix, ChDir, and the Delete tag (which might delete n)
+void Graph::readDirective(Node* n, const StringA& tags, String& namePrefix, bool parseInfo) {
+  if(n->key=="Parent" && n->isOfType<NodeL>()) {
+    NodeL& P = n->get<NodeL>();
+    Node *nn = n->container.isNodeOfGraph;
+    CHECK(nn,"can set 'Parent' only within a subgraph node");
+    for(Node *par:P) nn->addParent(par);
+    delete n; n=nullptr;
+  }else if(n->key=="Quit") {
+    delete n; n=nullptr;
+  }else if(n->key=="Include") {
+    uint Nbefore = N;
+    FileToken& fil = n->get<FileToken>();
+    fil.cd_file();
+    includedFiles.append(fil.absolutePathName());
+    read(fil, parseInfo);
+    if(namePrefix.N) { //prepend a naming prefix to all nodes just read
+      for(uint i=Nbefore; i<N; i++) elem(i)->setKey(STRING(namePrefix <<elem(i)->key));
+      namePrefix.clear();
     }
+    fil.cd_start();
+    delete n; n=nullptr;
+  } else if(n->key=="Prefix") {
+    if(n->isOfType<String>()) {
+      namePrefix = n->get<String>();
+    } else if(n->isOfType<bool>() && !n->get<bool>()) {
+      namePrefix.clear();
+    } else LOG(-1) <<*n <<" is not a proper name prefix";
+    delete n; n=nullptr;
+  } else if(n->key=="ChDir") {
+    n->get<FileToken>().cd_file();
+  } else if(tags.N && tags(0)=="Delete") {
+//      n->key.remove(0);
+    NodeL dels = getNodes(n->key);
+    for(Node* d: dels) { delete d; d=nullptr; }
   }
-  if(parseInfo) getParseInfo(nullptr).end=is.tellg();
+}
 
+/// merges Edit nodes, deletes ChDir nodes, and reindexes
+void Graph::readFinish(uint Nbefore) {
   DEBUG(checkConsistency());
 
   //-- merge all Mege keys
@@ -680,58 +747,395 @@ void writeFromStream(std::ostream& os, std::istream& is, istream::pos_type beg,
   is.seekg(here);
 }
 
-#define PARSERR(x, pinfo) { \
-    cerr <<"[[error in parsing Graph file (line=" <<lineCount <<"): " <<x <<":\n  \""; \
-    writeFromStream(cerr, is, pinfo.beg, is.tellg()); \
-    cerr <<"<<<\"  ]]" <<endl; \
-    is.clear(); }
+//===========================================================================
+//
+// parsing: one grammar (readGraphFrom, readNodeFrom) over two token sources,
+// a std::istream (StreamTokens) and a (memory-mapped) buffer (BufferTokens)
+//
+
+uint graphParseThreads=0;
+
+namespace {
+
+template<class Tokens> void readGraphFrom(Graph& G, Tokens& in, bool parseInfo);
+
+/// read-only memory mapping of a whole text file
+struct MappedText {
+  const char* p=0;
+  size_t n=0;
+  MappedText(const char* filename) {
+    int fd = ::open(filename, O_RDONLY);
+    if(fd<0) THROW("could not open file '" <<filename <<"' for input from '" <<getcwd_string() <<"'");
+    struct stat st;
+    if(fstat(fd, &st)) { ::close(fd); HALT("could not stat file '" <<filename <<"'"); }
+    n = st.st_size;
+    if(n) {
+      void* m = mmap(0, n, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(m==MAP_FAILED) { ::close(fd); HALT("could not map file '" <<filename <<"'"); }
+      madvise(m, n, MADV_SEQUENTIAL);
+      p = (const char*)m;
+    }
+    ::close(fd);
+  }
+  ~MappedText() { if(n) munmap((void*)p, n); }
+};
+
+/// streambuf over a memory range -- for the rare value formats left to the stream parsers
+struct MemBuf : std::streambuf {
+  MemBuf(const char* b, const char* e) { setg((char*)b, (char*)b, (char*)e); }
+  const char* pos() const { return gptr(); }
+};
+
+/// a subgraph body whose parsing is deferred to a parallel pass
+struct DeferredBody {
+  Graph* G;
+  const char *beg, *end;
+  uint line;  ///< line number at beg
+  StringA tags;
+};
+
+/// subgraph bodies below this size are not worth a parallel task
+const size_t deferMinSize=1<<12;
+
+void addSubgraphTags(Graph& subgraph, const StringA& tags) {
+  if(tags.N>1) {
+    for(uint i=0; i<tags.N-1; i++) subgraph.newNode<bool>(STRING('%' <<tags.elem(i)));
+  }
+}
+
+/// the grammar's tokens from a std::istream
+struct StreamTokens {
+  std::istream& is;
+
+  StreamTokens(std::istream& _is) : is(_is) {}
+
+  istream::pos_type tellg() { return is.tellg(); }
+  bool good() { return is.good(); }
+  void clear() { is.clear(); }
+  void skip(const char* skipSymbols) { rai::skip(is, skipSymbols); }
+  void skipTo(const char* stopSymbols) { rai::skip(is, nullptr, stopSymbols, false); }
+  char getNextChar(const char* skipSymbols) { return rai::getNextChar(is, skipSymbols); }
+  char peerNextChar(const char* skipSymbols) { return rai::peerNextChar(is, skipSymbols); }
+  void putback(char c) { is.putback(c); }
+  uint readStr(String& s, const char* skipSymbols, const char* stopSymbols, bool eatStopSymbol) { return s.read(is, skipSymbols, stopSymbols, eatStopSymbol); }
+  bool parse(const char* s) { return rai::parse(is, s); }
+  bool readDouble(double& x) { try { is >>x; } catch(...) { return false; } return true; }
+  template<class T> void read(T& x) { is >>x; }
+
+  /// the ascii format of Array<String>::read, but with the string symbols as arguments instead of the String::read defaults (shared by all threads)
+  void readStrings(StringA& x, const char* skipSymbols, const char* stopSymbols, bool eatStopSymbol) {
+    x.clear();
+    if(rai::peerNextChar(is, " \n\r\t")=='[') is.get();
+    uint d=0;
+    for(;;) {
+      rai::skip(is, " ,\r\t");
+      char c=is.get();
+      if(c==']' || !is.good()) { is.clear(); break; }
+      if(c==';' || c=='\n') { //set an array width
+        if(c=='\n') lineCount++;
+        if(!d) d=x.N; else if(x.N%d) HALT("Error in parsing Array (line=" <<lineCount <<"): mis-structured array in row " <<x.N/d);
+        continue;
+      }
+      if(c!=',') is.putback(c);
+      x.append().read(is, skipSymbols, stopSymbols, eatStopSymbol);
+    }
+    if(d) {
+      if(x.N%d) HALT("Error in parsing Array (line=" <<lineCount <<"): mis-structured array in last row");
+      x.reshape(x.N/d, d);
+    }
+  }
+
+  void readSubgraph(Graph& subgraph, const StringA& tags) {
+    readGraphFrom(subgraph, *this, false);
+    parse("}");
+    addSubgraphTags(subgraph, tags);
+  }
+
+  void flush() {}
+
+  void error(istream::pos_type beg, const String& msg) {
+    cerr <<"[[error in parsing Graph file (line=" <<lineCount <<"): " <<msg <<":\n  \"";
+    writeFromStream(cerr, is, beg, is.tellg());
+    cerr <<"<<<\"  ]]" <<endl;
+    is.clear();
+  }
+};
+
+/// the grammar's tokens directly from a (memory-mapped) buffer; large independent top-level subgraph bodies may be deferred to a parallel pass
+struct BufferTokens {
+  const char *beg, *p, *end;
+  const char* got[2]={0, 0}; ///< positions of the last two chars returned by getNextChar, for putback
+  uint* lines;           ///< newline counter: the global lineCount, or a deferred body's own one
+  bool failed=false;    ///< like a stream's failbit: ends the current (sub)graph
+  bool parallel=false;  ///< whether large top-level subgraphs are deferred to flush()
+  uint depth=0;         ///< subgraph nesting
+  std::vector<DeferredBody> deferred;
+
+  BufferTokens(const char* _beg, const char* _end, uint* _lines) : beg(_beg), p(_beg), end(_end), lines(_lines) {}
+
+  int get() { return p<end ? *p++ : -1; }
+
+  istream::pos_type tellg() { return p-beg; }
+  bool good() { return !failed && p<end; }
+  void clear() { failed=false; }
+
+  /// same as rai::skip
+  void skip(const char* skipSymbols) {
+    for(; p<end; p++) {
+      if(*p=='#') { while(p<end && *p!='\n') p++; if(p==end) break; }
+      if(skipSymbols && !contains(skipSymbols, *p)) break;
+      if(*p=='\n') (*lines)++;
+    }
+  }
 
-//  if(node) cerr <<"  (node='" <<*node <<"')" <<endl;
+  void skipTo(const char* stopSymbols) {
+    for(; p<end && !contains(stopSymbols, *p); p++) if(*p=='\n') (*lines)++;
+  }
+
+  /// same as rai::getNextChar: eats and returns the next non-skipped char, 0 at the end
+  char getNextChar(const char* skipSymbols) {
+    skip(skipSymbols);
+    if(p==end) return 0;
+    got[1]=got[0];
+    got[0]=p;
+    return *p++;
+  }
+
+  char peerNextChar(const char* skipSymbols) {
+    skip(skipSymbols);
+    return p<end ? *p : 0;
+  }
+
+  /// like istream::putback after getNextChar: the second putback returns to the char before
+  void putback(char c) {
+    if(!c) return;
+    p=got[0];
+    got[0]=got[1];
+  }
 
-void readNodeParents(Graph& G, std::istream& is, NodeL& parents, ParseInfo& pinfo) {
+  /// same as String::read: skips, then reads until a stop symbol; returns the length
+  uint readStr(String& s, const char* skipSymbols, const char* stopSymbols, bool eatStopSymbol) {
+    skip(skipSymbols);
+    const char* q=p;
+    while(q<end && !contains(stopSymbols, *q)) q++;
+    s.set(p, q-p);
+    s.resetIstream(); //set() keeps the read position of a string of equal length
+    p=q;
+    if(p<end && eatStopSymbol) p++;
+    return s.N;
+  }
+
+  /// same as rai::parse: skips white space and eats the given string
+  bool parse(const char* s) {
+    if(failed) { RAI_MSG("bad stream tag when scanning for '" <<s <<"'"); return false; }
+    skip(" \n\r\t");
+    size_t n=strlen(s);
+    if((size_t)(end-p)<n || memcmp(p, s, n)) {
+      RAI_MSG("(LINE=" <<*lines <<") parsing of constant string '" <<s <<"' failed! (read instead: '" <<std::string(p, std::min(n, (size_t)(end-p))) <<"')");
+      failed=true;
+      return false;
+    }
+    p+=n;
+    return true;
+  }
+
+  void error(istream::pos_type from, const String& msg) {
+    cerr <<"[[error in parsing Graph file (line=" <<*lines <<"): " <<msg <<":\n  \"" <<std::string(beg+std::streamoff(from), p) <<"<<<\"  ]]" <<endl;
+  }
+
+  /// same as 'is >>x' for a double, but without locale and stream overhead
+  bool readNumber(double& x) {
+    while(p<end && isspace((unsigned char)*p)) { if(*p=='\n') (*lines)++; p++; }
+    char buf[64];
+    uint n=0;
+    while(p+n<end && n<63 && contains("0123456789+-.eE", p[n])) { buf[n]=p[n]; n++; }
+    buf[n]=0;
+    char* e;
+    x=strtod(buf, &e);
+    if(e==buf) { x=0.; return false; }
+    p += e-buf;
+    return true;
+  }
+
+  bool readDouble(double& x) {
+    if(readNumber(x)) return true;
+    failed=true;
+    return false;
+  }
+
+  /// same as the ascii formats of Array<T>::read; returns false (and eats nothing) if the array has a <dim> tag, unless dimTags=false
+  template<class T, class F> bool readArray(Array<T>& x, const F& readElem, bool dimTags=true) {
+    const char* start=p;
+    int c=peerNextChar(" \n\r\t");
+    if(c=='[') { p++; c=peerNextChar(" \n\r\t"); }
+    if(dimTags && c=='<') { p=start; return false; }
+    uint i=0, d=0;
+    T e;
+    x.clear();
+    for(;;) {
+      skip(" ,\r\t");
+      c=get();
+      if(c==']' || c==-1) break;
+      if(c==';' || c=='\n') { //set an array width
+        if(c=='\n') (*lines)++;
+        if(!d) d=i; else if(d && i%d) HALT("Error in parsing Array (line=" <<*lines <<"): mis-structured array in row " <<i/d);
+        continue;
+      }
+      if(c!=',') p--;
+      if(!readElem(e)) break;
+      if(i>=x.N) x.resizeCopy(i+1000/sizeof(T));
+      x.elem(i)=e;
+      i++;
+    }
+    x.resizeCopy(i);
+    if(d) {
+      if(x.N%d) HALT("Error in parsing Array (line=" <<*lines <<"): mis-structured array in last row");
+      x.reshape(x.N/d, d);
+    }
+    return true;
+  }
+
+  template<class T> void readFromStream(T& x) {
+    MemBuf buf(p, end);
+    std::istream is(&buf);
+    is >>x;
+    p = buf.pos();
+  }
+
+  void read(arr& x) {
+    if(!readArray(x, [this](double& d) { return readNumber(d); })) readFromStream(x);
+  }
+
+  void read(arrA& x) {
+    if(!readArray(x, [this](arr& a) { read(a); return true; })) readFromStream(x);
+  }
+
+  void readStrings(StringA& x, const char* skipSymbols, const char* stopSymbols, bool eatStopSymbol) {
+    readArray(x, [&](String& s) { readStr(s, skipSymbols, stopSymbols, eatStopSymbol); return true; }, false);
+  }
+
+  /// if the subgraph body at p depends on nothing outside (no parent references, includes, chdirs, or <dim> tags), returns its closing '}'
+  const char* scanIndependentBody() {
+    const char* delim=" \t\r\n,;{}[]():=!";
+    char prev=' ';
+    int depth=1;
+    for(const char* q=p; q<end; q++) {
+      char c=*q;
+      switch(c) {
+        case '#': if(contains(delim, prev)) { while(q+1<end && q[1]!='\n') q++; } break;
+        case '"': case '\'': {
+          q = (const char*)memchr(q+1, c, end-q-1);
+          if(!q) return 0;
+        } break;
+        case '<': if(contains(delim, prev)) {
+            q = (const char*)memchr(q+1, '>', end-q-1);
+            if(!q) return 0;
+          } break;
+        case '(': return 0;
+        case '[': {
+          const char* r=q+1;
+          while(r<end && isspace((unsigned char)*r)) r++;
+          if(r<end && *r=='<') return 0;
+        } break;
+        case '{': depth++; break;
+        case '}': if(!--depth) {
+            if(memmem(p, q-p, "Include", 7) || memmem(p, q-p, "ChDir", 5)) return 0;
+            return q;
+          } break;
+      }
+      prev=c;
+    }
+    return 0;
+  }
+
+  void readSubgraph(Graph& subgraph, const StringA& tags) {
+    const char* close = (parallel && !depth) ? scanIndependentBody() : nullptr;
+    if(close && size_t(close-p)>=deferMinSize) {
+      deferred.push_back({&subgraph, p, close, *lines, tags});
+      for(const char* q=p; (q=(const char*)memchr(q, '\n', close-q)); q++)(*lines)++;
+      p=close+1;
+    } else {
+      depth++;
+      readGraphFrom(subgraph, *this, false);
+      depth--;
+      parse("}");
+      addSubgraphTags(subgraph, tags);
+    }
+  }
+
+  /// parses the deferred subgraph bodies, in parallel
+  void flush() {
+    if(depth || !deferred.size()) return;
+    String err;
+#ifdef _OPENMP
+    int nThreads = graphParseThreads ? graphParseThreads : omp_get_max_threads();
+    nThreads = std::max(1, std::min<int>(nThreads, deferred.size()));
+    #pragma omp parallel for num_threads(nThreads) schedule(dynamic)
+#endif
+    for(uint i=0; i<deferred.size(); i++) {
+      DeferredBody& d = deferred[i];
+      uint lines=d.line;
+      try {
+        BufferTokens in(d.beg, d.end, &lines);
+        readGraphFrom(*d.G, in, false);
+        if(in.p!=d.end) HALT("subgraph body ended before its closing '}' (parse sequentially with graphParseThreads=1)");
+        addSubgraphTags(*d.G, d.tags);
+      } catch(const std::exception& ex) {
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        err = ex.what();
+      }
+    }
+    deferred.clear();
+    if(err.N) HALT("parallel parsing of a subgraph failed: " <<err);
+  }
+};
+
+template<class Tokens> void readNodeParents(Graph& G, Tokens& in, NodeL& parents, ParseInfo& pinfo) {
   String str;
-  pinfo.parents_beg=is.tellg();
+  pinfo.parents_beg=in.tellg();
   for(uint j=0;; j++) {
-    if(!str.read(is, " \t\n\r,", " \t\n\r,)", false)) break;
+    if(!in.readStr(str, " \t\n\r,", " \t\n\r,)", false)) break;
     Node* e = G.findNode(str, true, false); //important: recurse up
     if(e) { //sucessfully found
       parents.append(e);
-      pinfo.parents_end=is.tellg();
+      pinfo.parents_end=in.tellg();
     } else { //this element is not known!!
       int rel=0;
       str >>rel;
       if(rel<0 && (int)G.N+rel>=0) { //check if this is a negative integer
         e=G.elem(G.N+rel);
         parents.append(e);
-        pinfo.parents_end=is.tellg();
+        pinfo.parents_end=in.tellg();
       } else {
-        PARSERR("unknown " <<j <<". parent '" <<str <<"'", pinfo);
-        skip(is, nullptr, ")", false);
+        in.error(pinfo.beg, STRING("unknown " <<j <<". parent '" <<str <<"'"));
+        in.skipTo(")");
       }
     }
   }
-  parse(is, ")");
+  in.parse(")");
 }
 
-Node* Graph::readNode(std::istream& is, StringA& tags, const char* predeterminedKey, bool verbose, bool parseInfo) {
+template<class Tokens> Node* readNodeFrom(Graph& G, Tokens& in, StringA& tags, const char* predeterminedKey, bool verbose, bool parseInfo) {
   String str;
 
   ParseInfo pinfo;
-  pinfo.beg=is.tellg();
+  pinfo.beg=in.tellg();
 
   if(verbose) { cout <<"\nNODE (line="<<lineCount <<")"; }
 
   //-- read keys
   tags.clear();
-  skip(is, " \t\n\r");
-  pinfo.keys_beg=is.tellg();
+  in.skip(" \t\n\r");
+  pinfo.keys_beg=in.tellg();
   for(;;) {
-    if(!str.read(is, " \t", " \t\n\r,;([{}=:!\'", false)) break;
+    if(!in.readStr(str, " \t", " \t\n\r,;([{}=:!\'", false)) break;
     if(str(0)=='"' && str(-1)=='"') str = str.getSubString(1, -2);
     tags.append(str);
-    pinfo.keys_end=is.tellg();
+    pinfo.keys_end=in.tellg();
   }
-  DEBUG(checkConsistency());
+  DEBUG(G.checkConsistency());
 
   if(verbose) { cout <<" tags:" <<tags <<std::flush; }
 
@@ -744,137 +1148,98 @@ Node* Graph::readNode(std::istream& is, StringA& tags, const char* predetermined
 
   //-- read parents
   NodeL parents;
-  char c=getNextChar(is, " \t"); //don't skip new lines
+  char c=in.getNextChar(" \t"); //don't skip new lines
   if(c=='(') {
-    readNodeParents(*this, is, parents, pinfo);
-    c=getNextChar(is, " \t");
+    readNodeParents(G, in, parents, pinfo);
+    c=in.getNextChar(" \t");
   }
-  DEBUG(checkConsistency());
+  DEBUG(G.checkConsistency());
 
   if(verbose) { cout <<" parents:"; if(!parents.N) cout <<"none"; else cout <<parents.modList() <<std::flush; }
 
   //-- read value
   Node* node=nullptr;
-  pinfo.value_beg=(long int)is.tellg()-1;
+  pinfo.value_beg=(long int)in.tellg()-1;
   if(c=='=' || c==':' || c=='{' || c=='[' || c=='<' || c=='!' || c=='\'') {
-    if(c=='=' || c==':') c=getNextChar(is, " \t");
+    if(c=='=' || c==':') c=in.getNextChar(" \t");
     if((c>='a' && c<='z') || (c>='A' && c<='Z') || c=='_' || c=='/') { //String or boolean
-      is.putback(c);
-      str.read(is, "", " \n\r\t,;}", false);
-      if(str=="true" || str=="True") node = newNode<bool>(key, parents, true);
-      else if(str=="false" || str=="False") node = newNode<bool>(key, parents, false);
-      else node = newNode<String>(key, parents, str);
-    } else if(rai::contains("-.0123456789", c)) {  //single double
-      is.putback(c);
+      in.putback(c);
+      in.readStr(str, "", " \n\r\t,;}", false);
+      if(str=="true" || str=="True") node = G.newNode<bool>(key, parents, true);
+      else if(str=="false" || str=="False") node = G.newNode<bool>(key, parents, false);
+      else node = G.newNode<String>(key, parents, str);
+    } else if(c && rai::contains("-.0123456789", c)) {  //single double
+      in.putback(c);
       double d;
-      try { is >>d; } catch(...) PARSERR("can't parse the double number", pinfo);
-      node = newNode<double>(key, parents, d);
+      if(!in.readDouble(d)) in.error(pinfo.beg, "can't parse the double number");
+      node = G.newNode<double>(key, parents, d);
     } else switch(c) {
         case '!': { //boolean false
-          node = newNode<bool>(key, parents, false);
+          node = G.newNode<bool>(key, parents, false);
         } break;
         case '\'': { //FileToken
-          str.read(is, "", "\'", true);
+          in.readStr(str, "", "\'", true);
           try {
-            node = newNode<FileToken>(key, parents, FileToken(str, false));
-//          node->get<FileToken>().getIs();  //creates the ifstream and might throw an error
+            node = G.newNode<FileToken>(key, parents, FileToken(str, false));
           } catch(...) {
             delete node; node=nullptr;
-            PARSERR("file " <<str <<" does not exist -> converting to string!", pinfo);
-            node = newNode<String>(key, parents, str);
+            in.error(pinfo.beg, STRING("file " <<str <<" does not exist -> converting to string!"));
+            node = G.newNode<String>(key, parents, str);
           }
         } break;
         case '\"': { //String
-          str.read(is, "", "\"", true);
-          node = newNode<String>(key, parents, str);
+          in.readStr(str, "", "\"", true);
+          node = G.newNode<String>(key, parents, str);
         } break;
         case '[': { //arr or StringA
-          char c2=getNextChar(is, " \t");
+          char c2=in.getNextChar(" \t");
+          in.putback(c2);
+          in.putback(c);
           if(c2=='"') { //StringA
-            is.putback(c2);
-            is.putback(c);
             StringA strings;
-            String::readSkipSymbols=",\"";
-            String::readStopSymbols="\"";
-            String::readEatStopSymbol = 1;
-            is >>strings;
-            String::readSkipSymbols = " \t";
-            String::readStopSymbols = ",\n\r";
-            String::readEatStopSymbol = 1;
-            node = newNode<StringA>(key, parents, strings);
+            in.readStrings(strings, ",\"", "\"", true);
+            node = G.newNode<StringA>(key, parents, strings);
           } else if(c2=='[') { //arrA
-            is.putback(c2);
-            is.putback(c);
             arrA reals;
-            is >>reals;
-            node = newNode<arrA>(key, parents, reals);
-          } else if((c2>='a' && c2<='z') || (c2>='A' && c2<='Z')) { //StringA}
-            is.putback(c2);
-            is.putback(c);
+            in.read(reals);
+            node = G.newNode<arrA>(key, parents, reals);
+          } else if((c2>='a' && c2<='z') || (c2>='A' && c2<='Z')) { //StringA
             StringA strings;
-            String::readStopSymbols=" ,\n\t]";
-            String::readEatStopSymbol = 0;
-            is >>strings;
-            String::readStopSymbols = ",\n\r";
-            String::readEatStopSymbol = 1;
-            node = newNode<StringA>(key, parents, strings);
+            in.readStrings(strings, " \t", " ,\n\t]", false);
+            node = G.newNode<StringA>(key, parents, strings);
           } else {
-            is.putback(c2);
-            is.putback(c);
             arr reals;
-            is >>reals;
-            node = newNode<arr>(key, parents, reals);
+            in.read(reals);
+            node = G.newNode<arr>(key, parents, reals);
           }
         } break;
         case '<': { //any type parser
-#if 1
-          str.read(is, "", ">", true);
-          node = newNode<String>(key, parents, str);
-#else
-          str.read(is, " \t", " \t\n\r()`-=~!@#$%^&*()+[]{};'\\:|,./<>?", false);
-          //      str.read(is, " \t", " \t\n\r()`1234567890-=~!@#$%^&*()_+[]{};'\\:|,./<>?", false);
-          //        node = readTypeIntoNode(*this, str, is);
-          if(!node) {
-            is.clear();
-            String substr;
-            substr.read(is, "", ">", false);
-            //          PARSERR("could not parse value of type '" <<str <<"' -- no such type has been registered; converting this to string: '"<<substr<<"'", pinfo);
-            str = STRING('<' <<str <<' ' <<substr <<'>');
-            node = newNode<String>(keys, parents, str);
-          } else {
-            node->keys = keys;
-            node->parents = parents;
-          }
-          parse(is, ">");
-#endif
+          in.readStr(str, "", ">", true);
+          node = G.newNode<String>(key, parents, str);
         } break;
         case '(': { // set of parent nodes
           NodeL par;
-          readNodeParents(*this, is, par, pinfo);
-          node = newNode<NodeL>(key, parents, par);
+          readNodeParents(G, in, par, pinfo);
+          node = G.newNode<NodeL>(key, parents, par);
         } break;
         case '{': { // sub graph
-          Graph& subgraph = this->newSubgraph(key, parents);
-          subgraph.read(is);
-          parse(is, "}");
+          Graph& subgraph = G.newSubgraph(key, parents);
+          in.readSubgraph(subgraph, tags);
           node = subgraph.isNodeOfGraph;
-          if(tags.N>1) {
-            for(uint i=0; i<tags.N-1; i++) subgraph.newNode<bool>(STRING('%' <<tags.elem(i)));
-          }
         } break;
         default: { //error
-          is.putback(c);
-          PARSERR("unknown value indicator '" <<c <<"'", pinfo);
+          in.putback(c);
+          in.error(pinfo.beg, STRING("unknown value indicator '" <<c <<"'"));
           return nullptr;
         }
       }
   } else { //no ':' or '{' -> boolean
-    is.putback(c);
-    node = newNode<bool>(key, parents, true);
+    in.putback(c);
+    node = G.newNode<bool>(key, parents, true);
   }
-  if(node) pinfo.value_end=is.tellg();
-  pinfo.end=is.tellg();
-  DEBUG(checkConsistency();)
+  if(node) pinfo.value_end=in.tellg();
+  pinfo.end=in.tellg();
+  DEBUG(G.checkConsistency();)
 
   if(parseInfo && node) node->container.getParseInfo(node) = pinfo;
 
@@ -898,12 +1263,57 @@ Node* Graph::readNode(std::istream& is, StringA& tags, const char* predetermined
   }
 
   //eat the next , or ;
-  c=getNextChar(is, " \n\r\t");
-  if(c==',' || c==';') {} else is.putback(c);
+  c=in.getNextChar(" \n\r\t");
+  if(c==',' || c==';') {} else in.putback(c);
 
   return node;
 }
 
+/// reads nodes until the end or an unmatched '}'
+template<class Tokens> void readGraphFrom(Graph& G, Tokens& in, bool parseInfo) {
+  uint Nbefore = G.N;
+  if(parseInfo) G.getParseInfo(nullptr).beg=in.tellg();
+  String namePrefix;
+  StringA tags;
+  for(;;) {
+    DEBUG(G.checkConsistency());
+    char c=in.peerNextChar(" \n\r\t,");
+    if(!in.good() || c=='}') { in.clear(); break; }
+    Node* n = readNodeFrom(G, in, tags, nullptr, false, parseInfo);
+    if(!n) break;
+    if(tags.N && tags(0)=="Delete") in.flush(); //it might delete deferred subgraphs
+    G.readDirective(n, tags, namePrefix, parseInfo);
+  }
+  in.flush();
+  if(parseInfo) G.getParseInfo(nullptr).end=in.tellg();
+  G.readFinish(Nbefore);
+}
+
+}
+
+void Graph::read(std::istream& is, bool parseInfo) {
+  StreamTokens in(is);
+  readGraphFrom(*this, in, parseInfo);
+}
+
+Node* Graph::readNode(std::istream& is, StringA& tags, const char* predeterminedKey, bool verbose, bool parseInfo) {
+  StreamTokens in(is);
+  return readNodeFrom(*this, in, tags, predeterminedKey, verbose, parseInfo);
+}
+
+void Graph::read(FileToken& file, bool parseInfo) {
+  if(parseInfo) { read(file.getIs(), true); return; }
+  MappedText text(file.name);
+  readBuffer(text.p, text.n);
+}
+
+size_t Graph::readBuffer(const char* buffer, size_t size) {
+  BufferTokens in(buffer, buffer+size, &lineCount);
+  in.parallel = graphParseThreads!=1;
+  readGraphFrom(*this, in, false);
+  return in.p-buffer;
+}
+
 #ifdef RAI_JSON
 void addJasonValues(Graph& G, const char* key, Json::Value& value);
 
@@ -14,6 +14,7 @@
 #include <math.h>
 #include <map>
 #include <memory>
+#include <unordered_map>
 
 //===========================================================================
 
@@ -37,7 +38,7 @@ namespace rai {
 struct Node {
   const std::type_info& type;
   Graph& container;
-  String key;
+  const String key; ///< change via setKey only
   NodeL parents;
   NodeL children;
   uint numChildren=0;
@@ -49,6 +50,7 @@ struct Node {
   void addParent(Node* p, bool prepend=false);
   void removeParent(Node* p);
   void swapParent(uint i, Node* p);
+  void setKey(const char* _key); ///< change the key (keeps the container's key index valid)
 
   //-- get value
   template<class T> bool isOfType() const { return type==typeid(T); }
@@ -93,6 +95,9 @@ struct Graph : NodeL {
   Node* isNodeOfGraph; ///< THIS is a subgraph of another graph; isNodeOfGraph points to the node that equals THIS graph
   bool isIndexed=true;
   bool isDoubleLinked=true;
+  bool isKeyIndexed=false;
+  std::unordered_map<std::string, NodeL> keyIndex; ///< if isKeyIndexed: key -> all nodes with this key (any order); maintained by Node constructor, destructor, and setKey
+  StringA includedFiles; ///< absolute paths of all files read via Include
 
   ArrayG<ParseInfo>* pi;     ///< optional annotation of nodes: when detailed file parsing is enabled
   ArrayG<RenderingInfo>* ri; ///< optional annotation of nodes: dot style commands
@@ -132,6 +137,8 @@ struct Graph : NodeL {
   Node* findNodeOfType(const std::type_info& type, const char* key, bool recurseUp=false, bool recurseDown=false) const;
   NodeL findNodesOfType(const std::type_info& type, const char* key, bool recurseUp=false, bool recurseDown=false) const;
   NodeL findGraphNodesWithTag(const char* tag) const;
+  const NodeL* findKeyBucket(const char* key) const; ///< (internal) the keyIndex entry; nullptr if no node has this key
+  void indexKeys(); ///< enable the key index (opt-in): keyed lookups become hash lookups, each node creation pays a hash insert
 
   //-- get nodes
   Node* operator[](const char* key) const { return findNode(key); } ///< returns nullptr if not found
@@ -178,6 +185,8 @@ struct Graph : NodeL {
   RenderingInfo& getRenderingInfo(Node* n);
 
   void read(std::istream& is, bool parseInfo=false);
+  void read(FileToken& file, bool parseInfo=false); ///< memory-maps the file and parses from the buffer (streamed only when parseInfo)
+  size_t readBuffer(const char* buffer, size_t size); ///< parses nodes until the end of the buffer or an unmatched '}'; returns the #chars consumed
   Node* readNode(std::istream& is, StringA& tags, const char* predeterminedKey, bool verbose, bool parseInfo); //used only internally..
   void readJson(std::istream& is);
   void write(std::ostream& os=cout, const char* ELEMSEP=",\n", const char* BRACKETS="{}", bool yamlMode=false) const;
@@ -190,12 +199,17 @@ struct Graph : NodeL {
   //private:
   friend struct Node;
   uint index(bool subKVG=false, uint start=0);
+  void readDirective(Node* n, const StringA& tags, String& namePrefix, bool parseInfo);
+  void readFinish(uint Nbefore);
 
 };
 
 bool operator==(const Graph& A, const Graph& B);
 stdPipes(Graph)
 
+/// threads for parsing large independent top-level subgraphs [default 0: the OpenMP default; 1: sequential]; results do not depend on it
+extern uint graphParseThreads;
+
 inline bool Node::isGraph() const { return type==typeid(Graph); }
 
 //===========================================================================
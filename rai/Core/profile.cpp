@@ -0,0 +1,269 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "profile.h"
+#include "util.h"
+
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <iomanip>
+#ifdef __GNUG__
+#  include <cxxabi.h>
+#endif
+
+namespace rai {
+
+int profileState=-1;
+
+struct ProfileNode {
+  const char* name;
+  bool isType;
+  ProfileNode* parent;
+  std::vector<ProfileNode*> children;
+  unsigned long calls=0;
+  long total=0, max=0; //nanoseconds
+
+  ProfileNode(const char* _name, bool _isType, ProfileNode* _parent) : name(_name), isType(_isType), parent(_parent) {}
+  ~ProfileNode() { for(ProfileNode* c:children) delete c; }
+
+  ProfileNode* child(const char* _name, bool _isType) {
+    for(ProfileNode* c:children) if(c->name==_name && c->isType==_isType) return c;
+    children.push_back(new ProfileNode(_name, _isType, this));
+    return children.back();
+  }
+};
+
+namespace {
+
+struct ProfileCounter {
+  const char* name;
+  unsigned long count=0;
+  double sum=0., max=0.;
+};
+
+struct TraceEvent {
+  const char* name;
+  bool isType;
+  long start, dur; //dur<0 for counter events
+  double value;
+};
+
+/// the records of one thread -- only that thread writes into them
+struct ProfileThread {
+  uint id;
+  ProfileNode root;
+  ProfileNode* current;
+  std::vector<ProfileCounter> counters;
+  std::vector<TraceEvent> events;
+  ProfileThread(uint _id) : id(_id), root("", false, nullptr), current(&root) {}
+};
+
+std::mutex profileMutex;
+std::vector<ProfileThread*>& profileThreads() { static auto* threads = new std::vector<ProfileThread*>; return *threads; } //never destroyed: threads may record until exit
+String profileTraceFile;
+bool profileReportAtExit=true;
+
+thread_local ProfileThread* thisProfileThread=nullptr;
+
+ProfileThread& profileThread() {
+  if(!thisProfileThread) {
+    std::lock_guard<std::mutex> lock(profileMutex);
+    thisProfileThread = new ProfileThread(profileThreads().size());
+    profileThreads().push_back(thisProfileThread);
+  }
+  return *thisProfileThread;
+}
+
+long profileNow() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+}
+
+String profileName(const char* name, bool isType) {
+  String s;
+#ifdef __GNUG__
+  if(isType) {
+    int status;
+    char* d = abi::__cxa_demangle(name, 0, 0, &status);
+    if(!status) { s=d; free(d); return s; }
+  }
+#endif
+  s=name;
+  return s;
+}
+
+/// the call trees of all threads merged by zone name
+struct MergedNode {
+  String name;
+  unsigned long calls=0;
+  long total=0, max=0;
+  std::vector<MergedNode> children;
+
+  void add(const ProfileNode& n) {
+    calls += n.calls;
+    total += n.total;
+    if(n.max>max) max=n.max;
+    for(ProfileNode* c:n.children) {
+      String cname = profileName(c->name, c->isType);
+      MergedNode* m=nullptr;
+      for(MergedNode& x:children) if(x.name==cname) { m=&x; break; }
+      if(!m) { children.push_back(MergedNode()); m=&children.back(); m->name=cname; }
+      m->add(*c);
+    }
+  }
+
+  void write(std::ostream& os, uint depth) const {
+    std::vector<const MergedNode*> sorted;
+    for(const MergedNode& c:children) sorted.push_back(&c);
+    std::sort(sorted.begin(), sorted.end(), [](const MergedNode* a, const MergedNode* b) { return a->total>b->total; });
+    for(const MergedNode* c:sorted) {
+      String label;
+      for(uint i=0; i<depth; i++) label <<"  ";
+      label <<c->name;
+      os <<std::left <<std::setw(40) <<label.p <<std::right
+         <<std::setw(10) <<c->calls
+         <<std::setw(12) <<1e-6*c->total
+         <<std::setw(12) <<1e-6*c->total/c->calls
+         <<std::setw(12) <<1e-6*c->max;
+      if(total) os <<std::setw(8) <<std::setprecision(3) <<100.*c->total/total <<'%' <<std::setprecision(6);
+      os <<'\n';
+      c->write(os, depth+1);
+    }
+  }
+};
+
+void writeJsonString(std::ostream& os, const String& s) {
+  os <<'"';
+  for(const char* c=s.p; c && *c; c++) {
+    if(*c=='"' || *c=='\\') os <<'\\';
+    os <<*c;
+  }
+  os <<'"';
+}
+
+struct ProfileAtExit {
+  ~ProfileAtExit() {
+    if(profileState<=0) return;
+    if(profileReportAtExit) profileReport(std::cout);
+    if(profileTraceFile.N) profileWriteTrace(profileTraceFile);
+  }
+} profileAtExit;
+
+} //namespace
+
+void profileInit() {
+  std::lock_guard<std::mutex> lock(profileMutex);
+  if(profileState>=0) return;
+  bool enable = getParameter<bool>("profile", false);
+  profileTraceFile = getParameter<String>("profile/trace", String());
+  profileReportAtExit = getParameter<bool>("profile/report", true);
+  profileState = enable ? (profileTraceFile.N ? 2 : 1) : 0;
+}
+
+void profileEnable(bool enable, bool trace) {
+  if(profileState<0) profileInit();
+  profileState = enable ? (trace ? 2 : 1) : 0;
+}
+
+void profileClear() {
+  std::lock_guard<std::mutex> lock(profileMutex);
+  for(ProfileThread* th:profileThreads()) {
+    CHECK_EQ(th->current, &th->root, "can't clear the profile while zones are open");
+    for(ProfileNode* c:th->root.children) delete c;
+    th->root.children.clear();
+    th->counters.clear();
+    th->events.clear();
+  }
+}
+
+void ProfileZone::enter(const char* name, bool isType) {
+  ProfileThread& th = profileThread();
+  node = th.current = th.current->child(name, isType);
+  start = profileNow();
+}
+
+void ProfileZone::leave() {
+  long dur = profileNow()-start;
+  node->calls++;
+  node->total += dur;
+  if(dur>node->max) node->max=dur;
+  ProfileThread& th = profileThread();
+  CHECK_EQ(th.current, node, "profile zones are not properly nested");
+  th.current = node->parent;
+  if(profileState==2) th.events.push_back({node->name, node->isType, start, dur, 0.});
+}
+
+void profileCounter(const char* name, double value) {
+  if(profileState<0) profileInit();
+  if(profileState<=0) return;
+  ProfileThread& th = profileThread();
+  ProfileCounter* c=nullptr;
+  for(ProfileCounter& x:th.counters) if(x.name==name) { c=&x; break; }
+  if(!c) { th.counters.push_back({name}); c=&th.counters.back(); }
+  if(!c->count || value>c->max) c->max=value;
+  c->count++;
+  c->sum += value;
+  if(profileState==2) th.events.push_back({name, false, profileNow(), -1, value});
+}
+
+void profileReport(std::ostream& os) {
+  std::lock_guard<std::mutex> lock(profileMutex);
+  MergedNode root;
+  for(ProfileThread* th:profileThreads()) root.add(th->root);
+  for(const MergedNode& c:root.children) root.total += c.total;
+  os <<"-- profile (" <<profileThreads().size() <<" threads)\n"
+     <<std::left <<std::setw(40) <<"zone" <<std::right
+     <<std::setw(10) <<"calls" <<std::setw(12) <<"total[ms]" <<std::setw(12) <<"mean[ms]" <<std::setw(12) <<"max[ms]" <<std::setw(9) <<"share" <<'\n';
+  root.write(os, 0);
+
+  std::vector<ProfileCounter> counters;
+  for(ProfileThread* th:profileThreads()) for(const ProfileCounter& c:th->counters) {
+    ProfileCounter* m=nullptr;
+    for(ProfileCounter& x:counters) if(!strcmp(x.name, c.name)) { m=&x; break; }
+    if(!m) { counters.push_back(c); continue; }
+    if(c.max>m->max) m->max=c.max;
+    m->count += c.count;
+    m->sum += c.sum;
+  }
+  if(counters.size()) {
+    os <<std::left <<std::setw(40) <<"counter" <<std::right <<std::setw(10) <<"count" <<std::setw(12) <<"mean" <<std::setw(12) <<"max" <<'\n';
+    for(const ProfileCounter& c:counters) {
+      os <<std::left <<std::setw(40) <<c.name <<std::right <<std::setw(10) <<c.count <<std::setw(12) <<c.sum/c.count <<std::setw(12) <<c.max <<'\n';
+    }
+  }
+  os <<std::flush;
+}
+
+void profileWriteTrace(const char* filename) {
+  std::lock_guard<std::mutex> lock(profileMutex);
+  std::ofstream fil(filename);
+  CHECK(fil.good(), "could not open trace file '" <<filename <<"'");
+  fil <<std::fixed <<std::setprecision(3);
+  fil <<"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first=true;
+  for(ProfileThread* th:profileThreads()) {
+    if(!first) fil <<",\n";
+    first=false;
+    fil <<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" <<th->id <<",\"args\":{\"name\":\"thread " <<th->id <<"\"}}";
+    for(const TraceEvent& e:th->events) {
+      fil <<",\n{\"name\":";
+      writeJsonString(fil, profileName(e.name, e.isType));
+      if(e.dur>=0) {
+        fil <<",\"ph\":\"X\",\"pid\":0,\"tid\":" <<th->id <<",\"ts\":" <<1e-3*e.start <<",\"dur\":" <<1e-3*e.dur <<'}';
+      } else {
+        fil <<",\"ph\":\"C\",\"pid\":0,\"tid\":" <<th->id <<",\"ts\":" <<1e-3*e.start <<",\"args\":{\"value\":" <<e.value <<"}}";
+      }
+    }
+  }
+  fil <<"\n]}\n";
+}
+
+} //namespace
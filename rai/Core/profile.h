@@ -0,0 +1,70 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include <iostream>
+#include <typeinfo>
+
+//===========================================================================
+//
+// hierarchical scoped profiling
+//
+
+/* Usage: place RAI_PROFILE("name") (or RAI_PROFILE_FUNCTION) at the top of a
+   scope. Zones nest per thread into a call tree; rai::profileReport prints the
+   aggregated tree, rai::profileWriteTrace the individual zones as a Chrome
+   trace (chrome://tracing or ui.perfetto.dev).
+
+   Profiling is always compiled in, but only records when enabled, by the
+   parameters
+     profile [false]       record zones and counters
+     profile/trace [""]    also record trace events and write them to this file at exit
+     profile/report [true] print the aggregated report at exit
+   or by profileEnable(). When disabled, a zone costs a single branch.
+
+   Zone names are not copied: pass string literals, __func__ or type_info. */
+
+namespace rai {
+
+struct ProfileNode;
+
+extern int profileState; ///< -1: not yet initialized from parameters, 0: disabled, 1: enabled, 2: enabled with trace events
+
+void profileInit(); ///< reads the parameters (called on first use)
+void profileEnable(bool enable=true, bool trace=false);
+void profileClear(); ///< discards all records -- only call when no zones are open
+void profileReport(std::ostream& os=std::cout);
+void profileWriteTrace(const char* filename);
+void profileCounter(const char* name, double value); ///< records a value (aggregated: count, mean, max; traced as counter)
+
+struct ProfileZone {
+  ProfileNode* node=nullptr;
+  long start;
+
+  ProfileZone(const char* name) {
+    if(profileState<0) profileInit();
+    if(profileState>0) enter(name, false);
+  }
+  ProfileZone(const std::type_info& type) {
+    if(profileState<0) profileInit();
+    if(profileState>0) enter(type.name(), true);
+  }
+  ~ProfileZone() { if(node) leave(); }
+
+private:
+  void enter(const char* name, bool isType);
+  void leave();
+};
+
+} //namespace
+
+#define RAI_PROFILE_CONCAT(a, b) a##b
+#define RAI_PROFILE_VAR(line) RAI_PROFILE_CONCAT(_profileZone_, line)
+#define RAI_PROFILE(name) rai::ProfileZone RAI_PROFILE_VAR(__LINE__)(name)
+#define RAI_PROFILE_FUNCTION RAI_PROFILE(__func__)
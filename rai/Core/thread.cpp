@@ -12,6 +12,7 @@
 #include <exception>
 #include <signal.h>
 #include <iomanip>
+#include <deque>
 
 #ifndef RAI_MSVC
 #ifndef __CYGWIN__
@@ -20,6 +21,8 @@
 #  include "cygwin_compat.h"
 #endif //__CYGWIN __
 #  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sched.h>
 #else
 #  define getpid _getpid
 #endif
@@ -289,6 +292,7 @@ Metronome::Metronome(double ticIntervalSec) {
 
 void Metronome::reset(double ticIntervalSec) {
   tics=0;
+  jitter.reset();
   ticInterval = ticIntervalSec;
   ticTime = std::chrono::high_resolution_clock::now();
 }
@@ -298,7 +302,10 @@ void Metronome::waitForTic() {
   std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::duration<double>> now = std::chrono::high_resolution_clock::now();
   if(ticTime>now){
     std::this_thread::sleep_until(ticTime);
+    now = std::chrono::high_resolution_clock::now();
+    jitter.add((now-ticTime).count(), false);
   }else{
+    jitter.add((now-ticTime).count(), true);
     ticTime = now;
   }
   tics++;
@@ -309,6 +316,43 @@ double Metronome::getTimeSinceTic() {
   return std::chrono::duration<double>(ticTime-now).count();
 }
 
+//===========================================================================
+//
+// JitterStats
+//
+
+void JitterStats::add(double jitter, bool overrun) {
+  if(jitter<0.) jitter=0.;
+  uint i=0;
+  for(double edge=1e-6; i<nBins-1 && jitter>=edge; edge*=2.) i++;
+  bins[i]++;
+  tics++;
+  if(overrun) overruns++;
+  sumJitter += jitter;
+  if(jitter>maxJitter) maxJitter=jitter;
+}
+
+double JitterStats::quantile(double p) const {
+  uint64_t n=0;
+  for(uint i=0; i<nBins; i++) {
+    n += bins[i];
+    if(n>=p*tics) return i<nBins-1 ? 1e-6*(1<<i) : maxJitter;
+  }
+  return maxJitter;
+}
+
+void JitterStats::write(std::ostream& os) const {
+  os <<"tics=" <<tics <<" overruns=" <<overruns;
+  if(!tics) return;
+  os <<" jitter[us]: mean=" <<1e6*sumJitter/tics <<" p99<" <<1e6*quantile(.99) <<" max=" <<1e6*maxJitter <<" histogram:";
+  for(uint i=0; i<nBins; i++) if(bins[i]) {
+    if(i==0) os <<" <1:";
+    else if(i<nBins-1) os <<' ' <<(1<<(i-1)) <<'-' <<(1<<i) <<':';
+    else os <<" >" <<(1<<(i-1)) <<':';
+    os <<bins[i];
+  }
+}
+
 //===========================================================================
 //
 // CycleTimer
@@ -394,6 +438,7 @@ Thread::~Thread() {
   }
 
 void Thread::threadOpen(bool wait, int priority) {
+  if(priority>0) rtPriority=priority;
   {
     auto lock = event.statusMutex(RAI_HERE);
     if(thread) return; //this is already open -- or has just beend opened (parallel call to threadOpen)
@@ -489,9 +534,7 @@ void Thread::threadStop(bool wait) {
 void Thread::main() {
   tid = getpid();
 //  if(verbose>0) cout <<"*** Entering Thread '" <<name <<"'" <<endl;
-  //http://linux.die.net/man/3/setpriority
-  //if(Thread::threadPriority) setRRscheduling(Thread::threadPriority);
-  //if(Thread::threadPriority) setNice(Thread::threadPriority);
+  setRealtime();
 
   {
     auto mux = stepMutex(RAI_HERE);
@@ -530,6 +573,7 @@ void Thread::main() {
     stepMutex.unlock();
     step_count++;
     timer.cycleDone();
+    if(s==tsBEATING) jitter.set(metronome.jitter);
 
     if(s>0) event.incrementStatus(0, -1); //step command -> reset to idle
   };
@@ -537,11 +581,35 @@ void Thread::main() {
   stepMutex.lock(RAI_HERE);
   close(); //virtual close routine
   stepMutex.unlock();
+  if(reportJitter) LOG(0) <<"timing of thread '" <<name <<"': " <<timer.report() <<"\n  " <<metronome.jitter;
 //  if(verbose>0) cout <<"*** Exiting Thread '" <<name <<"'" <<endl;
 
   event.setStatus(tsIsClosed);
 }
 
+void Thread::setRealtime() {
+#ifdef __linux__
+  if(lockMemory) {
+    if(mlockall(MCL_CURRENT | MCL_FUTURE)) LOG(-1) <<"thread '" <<name <<"': mlockall failed: " <<strerror(errno);
+  }
+  if(cpuCore>=0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpuCore, &cpus);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+    if(rc) LOG(-1) <<"thread '" <<name <<"': pinning to core " <<cpuCore <<" failed: " <<strerror(rc);
+  }
+  if(rtPriority>0) {
+    sched_param param;
+    param.sched_priority = rtPriority;
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if(rc) LOG(-1) <<"thread '" <<name <<"': SCHED_FIFO priority " <<rtPriority <<" failed: " <<strerror(rc) <<" (needs CAP_SYS_NICE or an rtprio limit)";
+  }
+#else
+  if(lockMemory || cpuCore>=0 || rtPriority>0) LOG(-1) <<"real-time options are only implemented for linux";
+#endif
+}
+
 //===========================================================================
 //
 // controlling threads
@@ -572,6 +640,151 @@ void signalhandler(int s) {
   }
 }
 
+//===========================================================================
+//
+// task pool
+//
+
+namespace rai {
+
+struct TaskPool::Worker {
+  std::mutex mutex;
+  std::deque<std::function<void()>> tasks;
+  std::thread thread;
+};
+
+static thread_local TaskPool* thisPool=nullptr; //the pool the calling thread works for (if any)
+static thread_local int thisWorker=-1;
+
+TaskPool::TaskPool(int nThreads, bool pin) : pending(0), nextQueue(0), stop(false) {
+  if(nThreads<0) nThreads = (int)std::thread::hardware_concurrency()-1;
+  if(nThreads<0) nThreads = 0;
+  workers.resize(nThreads);
+  for(uint i=0; i<workers.N; i++) workers(i) = new Worker;
+  for(uint i=0; i<workers.N; i++) {
+    workers(i)->thread = std::thread(&TaskPool::loop, this, i);
+#ifndef RAI_MSVC
+    pthread_setname_np(workers(i)->thread.native_handle(), STRING("task_" <<i).p);
+#endif
+#ifdef __linux__
+    if(pin) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET((i+1)%std::thread::hardware_concurrency(), &cpus);
+      int rc = pthread_setaffinity_np(workers(i)->thread.native_handle(), sizeof(cpu_set_t), &cpus);
+      if(rc) LOG(-1) <<"pinning task thread " <<i <<" failed: " <<strerror(rc);
+    }
+#endif
+  }
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stop=true;
+  }
+  sleepCond.notify_all();
+  for(Worker* w:workers) { w->thread.join(); delete w; }
+  workers.clear();
+}
+
+void TaskPool::submit(std::function<void()>&& task) {
+  if(!workers.N) { task(); return; }
+  uint q = (thisPool==this) ? thisWorker : (nextQueue++)%workers.N;
+  {
+    std::lock_guard<std::mutex> lock(workers(q)->mutex);
+    workers(q)->tasks.push_back(std::move(task));
+  }
+  pending++;
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  sleepCond.notify_one();
+}
+
+bool TaskPool::runOne() {
+  if(!workers.N || pending<=0) return false;
+  std::function<void()> task;
+  int self = (thisPool==this) ? thisWorker : -1;
+  if(self>=0) { //own queue, newest first
+    Worker* w = workers(self);
+    std::lock_guard<std::mutex> lock(w->mutex);
+    if(w->tasks.size()) { task = std::move(w->tasks.back()); w->tasks.pop_back(); }
+  }
+  for(uint k=1; !task && k<=workers.N; k++) { //steal, oldest first
+    Worker* w = workers((self+k+workers.N)%workers.N);
+    std::lock_guard<std::mutex> lock(w->mutex);
+    if(w->tasks.size()) { task = std::move(w->tasks.front()); w->tasks.pop_front(); }
+  }
+  if(!task) return false;
+  pending--;
+  task();
+  return true;
+}
+
+void TaskPool::loop(uint i) {
+  thisPool = this;
+  thisWorker = i;
+  for(;;) {
+    if(runOne()) continue;
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    sleepCond.wait(lock, [this]() { return stop || pending>0; });
+    if(stop) break;
+  }
+}
+
+TaskPool& taskPool() {
+  static TaskPool pool(getParameter<int>("taskPool/threads", -1), getParameter<bool>("taskPool/pin", false));
+  return pool;
+}
+
+TaskGroup::~TaskGroup() {
+  try { wait(); } catch(...) {}
+}
+
+void TaskGroup::run(const std::function<void()>& task) {
+  open++;
+  pool.submit([this, task]() {
+    try {
+      task();
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(doneMutex);
+      if(!error) error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if(--open==0) doneCond.notify_all();
+  });
+}
+
+void TaskGroup::wait() {
+  while(open>0) {
+    if(pool.runOne()) continue;
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCond.wait_for(lock, std::chrono::microseconds(100), [this]() { return open==0; });
+  }
+  std::lock_guard<std::mutex> lock(doneMutex); //the last task might still hold the lock
+  if(error) { std::exception_ptr e=error; error=nullptr; std::rethrow_exception(e); }
+}
+
+void parallel_for(uint n, const std::function<void(uint)>& f, uint grain) {
+  TaskPool& pool = taskPool();
+  if(!grain) grain = n/(4*(pool.numThreads()+1));
+  if(!grain) grain = 1;
+  if(!pool.numThreads() || n<=grain) {
+    for(uint i=0; i<n; i++) f(i);
+    return;
+  }
+  TaskGroup group(pool);
+  for(uint start=grain; start<n; start+=grain) {
+    uint stop = std::min(start+grain, n);
+    group.run([&f, start, stop]() { for(uint i=start; i<stop; i++) f(i); });
+  }
+  std::exception_ptr error;
+  try { for(uint i=0; i<grain; i++) f(i); } catch(...) { error = std::current_exception(); } //the caller does the first chunk
+  group.wait();
+  if(error) std::rethrow_exception(error);
+}
+
+} //namespace
+
 //===========================================================================
 //
 // Utils
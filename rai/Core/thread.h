@@ -15,6 +15,9 @@
 #include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
+#include <cstring>
+#include <future>
 
 enum ThreadState { tsIsClosed=-6, tsToOpen=-1, tsLOOPING=-2, tsBEATING=-3, tsIDLE=0, tsToStep=1, tsToClose=-4,  tsFAILURE=-5,  }; //positive states indicate steps-to-go
 struct Signaler;
@@ -222,6 +225,60 @@ struct Var {
 
 template<class T> std::ostream& operator<<(std::ostream& os, Var<T>& x) { x.write(os); return os; }
 
+//===========================================================================
+//
+// lock-free single-writer variables
+//
+
+/** A variable for trivially copyable (fixed-size) data with a single writer,
+    guarded by a sequence lock instead of the RWLock: readers copy the data
+    and retry if a write interleaved; they never block the writer. The
+    sequence counter is twice the revision (odd while writing). Revisions,
+    write/data times and callbacks (Events listening) are as for Var_data */
+template<class T>
+struct SeqVar_data : Var_base {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqVar requires a trivially copyable type");
+  std::atomic<uint> seq;
+  T data;
+
+  SeqVar_data(const char* name=0) : Var_base(name), seq(0), data() {}
+
+  int write(const T& x, double dataTime=-1.); ///< only one thread may write; returns the new revision
+  int read(T& x) const;                      ///< never blocks; returns the revision of the copy
+  int getRevision() const { return seq.load(std::memory_order_acquire)>>1; }
+};
+
+/** The access to a SeqVar_data, analogous to Var<T>, but with copy-in/copy-out
+    get/set instead of access tokens */
+template<class T>
+struct SeqVar {
+  shared_ptr<SeqVar_data<T>> data;
+  Thread* thread;             ///< which thread is the owner
+  int last_read_revision;     ///< last revision that has been read
+
+  SeqVar() : data(make_shared<SeqVar_data<T>>()), thread(0), last_read_revision(0) {}
+  SeqVar(const SeqVar<T>& v) : SeqVar(nullptr, v, false) {}
+  SeqVar(Thread* _thread, bool threadListens=false);
+  SeqVar(Thread* _thread, const SeqVar<T>& v, bool threadListens=false);
+
+  SeqVar& operator=(const SeqVar& v) { HALT("you can't copy SeqVar!") }
+
+  T get() { T x; last_read_revision = data->read(x); return x; } ///< copy of the latest data
+  int get(T& x) { return last_read_revision = data->read(x); }   ///< copies the latest data into x, returns its revision
+  int set(const T& x, double dataTime=-1.) { return data->write(x, dataTime); } ///< (single writer) publish a new revision
+  operator Var_base& () { return *data; }
+
+  rai::String& name() const { return data->name; }
+  int getRevision() { return data->getRevision(); }
+  bool hasNewRevision() { return getRevision()>last_read_revision; }
+  void waitForNextRevision(uint multipleRevisions=0) { waitForRevisionGreaterThan(last_read_revision+multipleRevisions); }
+  int waitForRevisionGreaterThan(int rev);
+
+  void addCallback(const std::function<void(Var_base*)>& call, const void* callbackID=0) {
+    data->addCallback(call, callbackID);
+  }
+};
+
 //===========================================================================
 
 /// a basic condition variable
@@ -285,11 +342,27 @@ inline bool wait(const VarL& acts, double timeout=-1.) {
 // Timing helpers
 //
 
+/// timing statistics of a periodic loop: a log2-histogram of wake-up jitter (delay after the scheduled tic) and overruns (tics that were already missed)
+struct JitterStats {
+  static const uint nBins=24;  ///< bin 0: <1us, bin i: [2^(i-1), 2^i)us, last bin: everything larger
+  uint64_t bins[nBins];
+  uint64_t tics, overruns;
+  double sumJitter, maxJitter; ///< in seconds
+
+  JitterStats() { reset(); }
+  void reset() { memset((void*)this, 0, sizeof(JitterStats)); }
+  void add(double jitter, bool overrun);
+  double quantile(double p) const; ///< upper bin edge [seconds] below which a fraction p of the jitters lie
+  void write(std::ostream& os) const;
+};
+stdOutPipe(JitterStats)
+
 /// a simple struct to realize a strict tic tac timing (called in thread::main once each step if looping)
 struct Metronome {
   double ticInterval;
   std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::duration<double>> ticTime;
   uint tics;
+  JitterStats jitter;
 
   Metronome(double ticIntervalSec); ///< set tic tac time in seconds
 
@@ -335,6 +408,13 @@ struct Thread {
   uint step_count;              ///< how often the step was called
   Metronome metronome;          ///< used for beat-looping
   CycleTimer timer;             ///< measure how the time spend per cycle, within step, idle
+  SeqVar<JitterStats> jitter;   ///< the metronome's jitter statistics, published after each beat
+
+  /// @name real-time options -- set before threadOpen; applied when the thread starts; failures (e.g. missing permissions) only warn
+  int rtPriority=0;             ///< >0: SCHED_FIFO with this priority (1..99)
+  int cpuCore=-1;               ///< >=0: pin the thread to this core
+  bool lockMemory=false;        ///< mlockall all current and future pages of the process
+  bool reportJitter=false;      ///< print the jitter statistics on close
 
   /// @name c'tor/d'tor
   /** DON'T open drivers/devices/files or so here in the constructor,
@@ -348,7 +428,7 @@ struct Thread {
   virtual ~Thread();
 
   /// @name to be called from `outside' (e.g. the main) to start/step/close the thread
-  void threadOpen(bool wait=false, int priority=0);      ///< start the thread (in idle mode) (should be positive for changes)
+  void threadOpen(bool wait=false, int priority=0);      ///< start the thread (in idle mode); priority>0 sets rtPriority
   void threadClose(double timeoutForce=-1.);                   ///< close the thread (stops looping and waits for idle mode before joining the thread)
   void threadStep();                    ///< trigger (multiple) step (idle -> working mode) (wait until idle? otherwise calling during non-idle -> error)
   void threadLoop(bool waitForOpened=false);  ///< loop, either with fixed beat or at full speed
@@ -376,6 +456,7 @@ struct Thread {
   virtual void close() {}
 
   void main(); //this is the thread main - should be private!
+  void setRealtime(); ///< applies the real-time options to the calling thread
 };
 
 //===========================================================================
@@ -406,6 +487,82 @@ inline shared_ptr<ScriptThread> run(const std::function<int ()>& script, double
   return make_shared<ScriptThread>(script, beatIntervalSec);
 }
 
+//===========================================================================
+//
+// task parallelism
+//
+
+namespace rai {
+
+/** A pool of worker threads for fine-grained task parallelism. Each worker
+    owns a task deque: it pops its own tasks LIFO and steals from others FIFO.
+    Whoever waits for tasks (TaskGroup::wait, TaskFuture::get, parallel_for)
+    executes pending tasks meanwhile -- nested parallel calls from within tasks
+    therefore cannot deadlock. With zero threads, tasks run inline on submit */
+struct TaskPool : NonCopyable {
+  struct Worker;
+  rai::Array<Worker*> workers;
+  std::atomic<int> pending;        ///< number of queued (not yet started) tasks
+  std::atomic<uint> nextQueue;     ///< round-robin queue for tasks submitted from outside the pool
+  std::atomic<bool> stop;
+  std::mutex sleepMutex;
+  std::condition_variable sleepCond;
+
+  TaskPool(int nThreads=-1, bool pin=false); ///< nThreads=-1: hardware concurrency minus one (the caller takes part when waiting); pin: worker i to core i+1
+  ~TaskPool();
+
+  uint numThreads() const { return workers.N; }
+  void submit(std::function<void()>&& task);
+  bool runOne(); ///< executes one pending task (own, or stolen) if there is one
+
+private:
+  void loop(uint i);
+};
+
+/// the process-wide pool, created on first use according to the parameters taskPool/threads [-1] and taskPool/pin [false]
+TaskPool& taskPool();
+
+/// a set of tasks to wait for jointly; the first exception thrown by a task is rethrown by wait()
+struct TaskGroup : NonCopyable {
+  TaskPool& pool;
+  std::atomic<int> open;
+  std::exception_ptr error;
+  std::mutex doneMutex;
+  std::condition_variable doneCond;
+
+  TaskGroup(TaskPool& _pool=taskPool()) : pool(_pool), open(0) {}
+  ~TaskGroup();
+
+  void run(const std::function<void()>& task);
+  void wait(); ///< executes pending tasks until all tasks of this group are done
+};
+
+/// calls f(i) for i in [0,n) in parallel chunks of size grain [default 0: about 4 chunks per thread]; returns when all are done
+void parallel_for(uint n, const std::function<void(uint)>& f, uint grain=0);
+
+/// the result of async(); get() executes pending tasks while waiting
+template<class T>
+struct TaskFuture {
+  std::future<T> future;
+  TaskPool* pool;
+  bool isReady() const { return future.wait_for(std::chrono::seconds(0))==std::future_status::ready; }
+  T get() {
+    while(!isReady()) if(!pool->runOne()) future.wait_for(std::chrono::microseconds(100));
+    return future.get();
+  }
+};
+
+/// runs f() as a task of the process-wide pool
+template<class F>
+auto async(F&& f) -> TaskFuture<decltype(f())> {
+  auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::forward<F>(f));
+  TaskFuture<decltype(f())> fut{task->get_future(), &taskPool()};
+  fut.pool->submit([task]() { (*task)(); });
+  return fut;
+}
+
+} //namespace
+
 // ================================================
 //
 // template definitions
@@ -447,3 +604,57 @@ int Var<T>::waitForRevisionGreaterThan(int rev) {
 
 template<class T>
 void Var<T>::stopListening() { thread->event.stopListenTo(data); }
+
+template<class T>
+int SeqVar_data<T>::write(const T& x, double dataTime) {
+  uint s = seq.load(std::memory_order_relaxed);
+  if((s&1) || !seq.compare_exchange_strong(s, s+1, std::memory_order_acquire)) HALT("SeqVar '" <<name <<"' is written by multiple threads");
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy((void*)&data, (const void*)&x, sizeof(T));
+  seq.store(s+2, std::memory_order_release);
+
+  //the RWLock now only guards the callback list (against listenTo/stopListenTo), never readers
+  rwlock.writeLock();
+  revision = (s+2)>>1;
+  write_time = rai::clockTime();
+  if(dataTime>=0.) data_time = dataTime;
+  for(auto* c:callbacks) c->call()(this);
+  rwlock.unlock();
+  return (s+2)>>1;
+}
+
+template<class T>
+int SeqVar_data<T>::read(T& x) const {
+  for(;;) {
+    uint s0 = seq.load(std::memory_order_acquire);
+    if(s0&1) { std::this_thread::yield(); continue; }
+    memcpy((void*)&x, (const void*)&data, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(seq.load(std::memory_order_relaxed)==s0) return s0>>1;
+  }
+}
+
+template<class T>
+SeqVar<T>::SeqVar(Thread* _thread, bool threadListens)
+  : data(make_shared<SeqVar_data<T>>()), thread(_thread), last_read_revision(0) {
+  if(thread && threadListens) thread->event.listenTo(*data);
+}
+
+template<class T>
+SeqVar<T>::SeqVar(Thread* _thread, const SeqVar<T>& v, bool threadListens)
+  : data(v.data), thread(_thread), last_read_revision(0) {
+  if(thread && threadListens) thread->event.listenTo(*data);
+}
+
+template<class T>
+int SeqVar<T>::waitForRevisionGreaterThan(int rev) {
+  EventFunction evFct = [&rev](const rai::Array<Var_base*>& vars, int whoChanged) -> int {
+    CHECK_EQ(vars.N, 1, ""); //this event only checks the revision for a single var
+    if(vars.elem()->revision > (uint)rev) return 1;
+    return 0;
+  };
+
+  Event ev({data.get()}, evFct, 0);
+  if(getRevision()<=rev) ev.waitForStatusEq(1);
+  return data->getRevision();
+}
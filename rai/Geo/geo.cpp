@@ -961,6 +961,11 @@ void Quaternion::applyOnPointArray(arr& pts) const {
 /// this is a 3-by-4 matrix $J$, giving the angular velocity vector $w = J \dot q$  induced by a $\dot q$
 arr Quaternion::getJacobian() const {
   arr J(3, 4);
+  getJacobian(J.p);
+  return J;
+}
+
+double* Quaternion::getJacobian(double* J) const {
   rai::Quaternion e;
   for(uint i=0; i<4; i++) {
     if(i==0) e.set(1., 0., 0., 0.);
@@ -968,9 +973,9 @@ arr Quaternion::getJacobian() const {
     if(i==2) e.set(0., 0., 1., 0.);
     if(i==3) e.set(0., 0., 0., 1.); //TODO: the following could be simplified/compressed/made more efficient
     e = e / *this;
-    J(0, i) = -2.*e.x;
-    J(1, i) = -2.*e.y;
-    J(2, i) = -2.*e.z;
+    J[0*4+i] = -2.*e.x;
+    J[1*4+i] = -2.*e.y;
+    J[2*4+i] = -2.*e.z;
   }
   return J;
 }
@@ -1005,12 +1010,17 @@ arr Quaternion::getQuaternionMultiplicationMatrix() const{
 //  a.x = b.w*c.x + b.x*c.w + b.y*c.z - b.z*c.y;
 //  a.y = b.w*c.y - b.x*c.z + b.y*c.w + b.z*c.x;
 //  a.z = b.w*c.z + b.x*c.y - b.y*c.x + b.z*c.w;
-  return arr(
-  {4,4},
-  {+w, -x, -y, -z,
-   +x, +w, +z, -y,
-   +y, -z, +w, +x,
-   +z, +y, -x, +w});
+  arr M(4, 4);
+  getQuaternionMultiplicationMatrix(M.p);
+  return M;
+}
+
+double* Quaternion::getQuaternionMultiplicationMatrix(double* M) const{
+  M[ 0]=+w; M[ 1]=-x; M[ 2]=-y; M[ 3]=-z;
+  M[ 4]=+x; M[ 5]=+w; M[ 6]=+z; M[ 7]=-y;
+  M[ 8]=+y; M[ 9]=-z; M[10]=+w; M[11]=+x;
+  M[12]=+z; M[13]=+y; M[14]=-x; M[15]=+w;
+  return M;
 }
 
 void Quaternion::writeNice(std::ostream& os) const { os <<"Quaternion: " <<getDeg() <<" around " <<getVec() <<"\n"; }
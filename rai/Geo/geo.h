@@ -167,9 +167,11 @@ struct Quaternion {
   void applyOnPointArray(arr& pts) const;
 
   arr getJacobian() const;
+  double* getJacobian(double* J) const; //3x4 memory storage
   arr getMatrixJacobian() const;
 
   arr getQuaternionMultiplicationMatrix() const; //turns a RHS(!) quat multiplication into a LHS(!) matrix multiplication
+  double* getQuaternionMultiplicationMatrix(double* M) const; //4x4 memory storage
 
   void writeNice(std::ostream& os) const;
   void write(std::ostream& os) const;
@@ -1118,6 +1118,7 @@ void rai::Mesh::write(std::ostream& os) const {
 
 void rai::Mesh::readFile(const char* filename) {
   const char* fileExtension = filename+(strlen(filename)-3);
+  if(!strcmp(fileExtension, "arr") && MappedArrays::isMappedFile(filename)) { readMapped(filename); return; }
   read(FILE(filename).getIs(), fileExtension, filename);
 }
 
@@ -1394,6 +1395,32 @@ void rai::Mesh::readArr(std::istream& is) {
   texImg.readTagged(is, "texImg");
 }
 
+/// same data as writeArr, in the mmap-able binary format (see MappedArrays)
+void rai::Mesh::writeMapped(const char* filename) const {
+  MappedArraysWriter W;
+  writeMapped(W, "");
+  W.write(filename);
+}
+
+void rai::Mesh::writeMapped(MappedArraysWriter& W, const char* prefix) const {
+  W.add(STRING(prefix <<"V"), V).add(STRING(prefix <<"T"), T).add(STRING(prefix <<"C"), C)
+   .add(STRING(prefix <<"tex"), tex).add(STRING(prefix <<"texImg"), texImg);
+}
+
+void rai::Mesh::readMapped(const char* filename) {
+  MappedArrays M(filename);
+  readMapped(M);
+}
+
+void rai::Mesh::readMapped(const MappedArrays& M, const char* prefix) {
+  //the mesh owns and modifies its buffers: copy out of the mapping (one memcpy per array, no parsing)
+  V = M.get<double>(STRING(prefix <<"V"));
+  T = M.get<uint>(STRING(prefix <<"T"));
+  C = M.get<double>(STRING(prefix <<"C"));
+  tex = M.get<double>(STRING(prefix <<"tex"));
+  texImg = M.get<byte>(STRING(prefix <<"texImg"));
+}
+
 
 //===========================================================================
 // Util
@@ -131,6 +131,10 @@ struct Mesh : GLDrawer {
   void readPLY(const char* fn);
   void writeArr(std::ostream&);
   void readArr(std::istream&);
+  void writeMapped(const char* filename) const;
+  void writeMapped(MappedArraysWriter& W, const char* prefix) const; ///< add the arrays to W, tags prefixed
+  void readMapped(const char* filename);
+  void readMapped(const MappedArrays& M, const char* prefix="");
 
   void glDraw(struct OpenGL&);
 };
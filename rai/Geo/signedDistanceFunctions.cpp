@@ -420,11 +420,38 @@ void SDF_GridData::write(std::ostream& os) const {
 }
 
 void SDF_GridData::read(std::istream& is){
+  if(mapping){ gridData.clear(); mapping.reset(); }
   lo.readTagged(is,"lo");
   up.readTagged(is,"up");
   gridData.readTagged(is, "sdf");
 }
 
+void SDF_GridData::writeMapped(const char* filename) const {
+  rai::MappedArraysWriter W;
+  writeMapped(W, "");
+  W.write(filename);
+}
+
+void SDF_GridData::writeMapped(rai::MappedArraysWriter& W, const char* prefix) const {
+  W.add(STRING(prefix <<"lo"), lo).add(STRING(prefix <<"up"), up).add(STRING(prefix <<"sdf"), gridData);
+}
+
+void SDF_GridData::readMapped(const char* filename, bool copyOnWrite){
+  readMapped(std::make_shared<rai::MappedArrays>(filename, copyOnWrite));
+}
+
+void SDF_GridData::readMapped(const std::shared_ptr<rai::MappedArrays>& M, const char* prefix){
+  lo = M->get<double>(STRING(prefix <<"lo"));
+  up = M->get<double>(STRING(prefix <<"up"));
+  gridData.referTo(M->get<float>(STRING(prefix <<"sdf"))); //zero-copy; the mapping lives as long as this
+  mapping = M;
+}
+
+void SDF_GridData::readFile(const char* filename){
+  if(rai::MappedArrays::isMappedFile(filename)) readMapped(filename);
+  else read(FILE(filename));
+}
+
 //===========================================================================
 
 double SDF_SuperQuadric::f(arr& g, arr& H, const arr& x) {
@@ -83,6 +83,7 @@ struct SDF_GridData : SDF {
   rai::Transformation pose=0;
   floatA gridData;
   arr lo, up;
+  std::shared_ptr<rai::MappedArrays> mapping; ///< set by readMapped: gridData refers into this file mapping
   SDF_GridData(const rai::Transformation& _pose, const floatA& _data, const arr& _lo, const arr& _up)
     : pose(_pose), gridData(_data), lo(_lo), up(_up) {}
 
@@ -94,6 +95,11 @@ struct SDF_GridData : SDF {
 
   void write(std::ostream& os) const;
   void read(std::istream& is);
+  void writeMapped(const char* filename) const;
+  void writeMapped(rai::MappedArraysWriter& W, const char* prefix) const; ///< add the arrays to W, tags prefixed
+  void readMapped(const char* filename, bool copyOnWrite=false);
+  void readMapped(const std::shared_ptr<rai::MappedArrays>& M, const char* prefix="");
+  void readFile(const char* filename); ///< reads either format
 };
 stdPipes(SDF_GridData)
 
@@ -35,6 +35,7 @@
 #include "../Optim/opt-ceres.h"
 
 #include "../Core/util.ipp"
+#include "../Core/profile.h"
 
 #include "pathTools.h"
 
@@ -1305,6 +1306,7 @@ void KOMO::addStableFrame(const char* name, const char* parent, JointType jointT
     pathConfig.frames = timeSlices;
     uint i=0;
     for(Frame* f: pathConfig.frames) f->ID = i++;
+    pathConfig._state_frameIndex_isGood=false;
   }
 }
 
@@ -1457,20 +1459,25 @@ void KOMO::checkBounds(const arr& x) {
 }
 
 void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
+  RAI_PROFILE("KOMO::set_x");
   CHECK_EQ(timeSlices.d0, k_order+T, "configurations are not setup yet");
 
   timeKinematics -= rai::cpuTime();
 
-  if(!selectedConfigurationsOnly.N){
-    pathConfig.setJointState(x);
-  }else{
-    pathConfig.setJointState(x, timeSlices.sub(selectedConfigurationsOnly+k_order));
-    HALT("this is untested...");
+  {
+    RAI_PROFILE("kinematics");
+    if(!selectedConfigurationsOnly.N){
+      pathConfig.setJointState(x);
+    }else{
+      pathConfig.setJointState(x, timeSlices.sub(selectedConfigurationsOnly+k_order));
+      HALT("this is untested...");
+    }
   }
 
   timeKinematics += rai::cpuTime();
 
   if(computeCollisions) {
+    RAI_PROFILE("collisions");
     timeCollisions -= rai::cpuTime();
     pathConfig.proxies.clear();
     arr X;
@@ -34,6 +34,7 @@ namespace rai {
     RAI_PARAM("KOMO/", bool, mimicStable, true)
     RAI_PARAM("KOMO/", bool, useFCL, true)
     RAI_PARAM("KOMO/", bool, unscaleEqIneqReport, false)
+    RAI_PARAM("KOMO/", bool, exactHessians, false) //add the exact curvature of sos/f features to the Gauss-Newton Hessian (may make it indefinite)
   };
 }//namespace
 
@@ -1,4 +1,5 @@
 #include "komo_NLP.h"
+#include "../Core/profile.h"
 
 #include "../Kin/frame.h"
 #include "../Kin/proxy.h"
@@ -47,9 +48,12 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
   komo.sos=komo.ineq=komo.eq=0.;
 
   komo.timeFeatures -= cpuTime();
+  RAI_PROFILE("KOMO::features");
 
   uint M=0;
   for(shared_ptr<GroundedObjective>& ob : komo.objs) {
+      RAI_PROFILE(typeid(*ob->feat)); //aggregated per feature type
+      ArenaScope arena; //all temporaries of this feature evaluation are bump-allocated
       //query the task map and check dimensionalities of returns
       arr y = ob->feat->eval(ob->frames);
 //      cout <<"EVAL '" <<ob->name() <<"' phi:" <<y <<endl <<y.J() <<endl<<endl;
@@ -115,6 +119,45 @@ void Conv_KOMO_NLP::getFHessian(arr& H, const arr& x) {
   } else {
     H.clear();
   }
+  if(komo.opt.exactHessians) addFeatureHessians(H, x);
+}
+
+/// adds the second-order (curvature) terms sum_i c_i d^2 y_i/dxdx of the sos and f features, with c_i=2y_i for sos
+/// and c_i=1 for f terms, for all features that provide exact Hessians -- the others remain Gauss-Newton only.
+/// Unlike J^T J, these terms are not positive semi-definite: away from small residuals the Hessian can become indefinite
+void Conv_KOMO_NLP::addFeatureHessians(arr& H, const arr& x) {
+  if(komo.x!=x || komo.featureValues.N+quadraticPotentialLinear.N!=featureTypes.N) {
+    arr phi;
+    evaluate(phi, NoArr, x);
+  }
+
+  if(!H.N) {
+    if(sparse) H.sparse().resize(x.N, x.N, 0);
+    else H.resize(x.N, x.N).setZero();
+  }
+  bool sparseH = isSparseMatrix(H);
+
+  RAI_PROFILE("KOMO::featureHessians");
+  uint M=0;
+  arr Hf;
+  uintA cols;
+  for(shared_ptr<GroundedObjective>& ob : komo.objs) {
+    uint d = ob->feat->dim(ob->frames);
+    if(d && (ob->type==OT_sos || ob->type==OT_f)) {
+      arr c = komo.featureValues({M, M+d-1});
+      if(ob->type==OT_sos) c *= 2.;
+      else c = 1.;
+      if(ob->feat->evalHessian(Hf, cols, c, ob->frames)) {
+        for(uint i=0; i<cols.N; i++) for(uint j=0; j<cols.N; j++) {
+          double h = Hf(i, j);
+          if(!h) continue;
+          if(sparseH) H.sparse().addEntry(cols(i), cols(j)) = h;
+          else H(cols(i), cols(j)) += h;
+        }
+      }
+    }
+    M += d;
+  }
 }
 
 void Conv_KOMO_NLP::report(std::ostream& os, int verbose, const char* msg) {
@@ -150,6 +193,7 @@ Conv_KOMO_NLP::Conv_KOMO_NLP(KOMO& _komo, bool sparse) : komo(_komo), sparse(spa
     featureTypes.append(OT_f);
   }
   komo.featureTypes = featureTypes;
+  sosHessian = komo.opt.exactHessians;
 }
 
 arr Conv_KOMO_NLP::getInitializationSample(const arr& previousOptima) {
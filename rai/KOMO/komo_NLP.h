@@ -16,6 +16,7 @@ struct Conv_KOMO_NLP : NLP {
   virtual arr getInitializationSample(const arr& previousOptima= {});
   virtual void evaluate(arr& phi, arr& J, const arr& x);
   virtual void getFHessian(arr& H, const arr& x);
+  void addFeatureHessians(arr& H, const arr& x); ///< exact curvature of sos/f features (if KOMO/exactHessians)
 
   virtual void report(ostream& os, int verbose, const char* msg=0);
 };
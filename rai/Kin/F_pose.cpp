@@ -9,6 +9,16 @@
 #include "F_pose.h"
 #include "TM_default.h"
 
+/// the block-diagonal Hessian of two terms over the concatenated columns (which may overlap -- entries add up)
+static void catHessians(arr& H, uintA& cols, const arr& H1, const uintA& cols1, const arr& H2, const uintA& cols2){
+  uint n1=cols1.N, n2=cols2.N;
+  H.resize(n1+n2, n1+n2).setZero();
+  if(n1) H.setMatrixBlock(H1, 0, 0);
+  if(n2) H.setMatrixBlock(H2, n1, n1);
+  cols = cols1;
+  cols.append(cols2);
+}
+
 //===========================================================================
 
 void F_Position::phi2(arr& y, arr& J, const FrameL& F) {
@@ -18,6 +28,14 @@ void F_Position::phi2(arr& y, arr& J, const FrameL& F) {
   f->C.kinematicsPos(y, J, f);
 }
 
+bool F_Position::phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F) {
+  CHECK_EQ(F.N, 1, "");
+  rai::Frame *f = F.elem(0);
+  if(!f->C.hessian_pos(H, f, f->ensure_X().pos, c)) return false;
+  cols = f->C.jacobian_chainColumns(f);
+  return true;
+}
+
 //===========================================================================
 
 arr F_PositionDiff::phi(const FrameL& F) {
@@ -28,6 +46,17 @@ arr F_PositionDiff::phi(const FrameL& F) {
   return p1-p2;
 }
 
+bool F_PositionDiff::phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F) {
+  CHECK_EQ(F.N, 2, "");
+  rai::Frame *f1 = F.elem(0);
+  rai::Frame *f2 = F.elem(1);
+  arr H1, H2;
+  if(!f1->C.hessian_pos(H1, f1, f1->ensure_X().pos, c)) return false;
+  if(!f2->C.hessian_pos(H2, f2, f2->ensure_X().pos, -c)) return false;
+  catHessians(H, cols, H1, f1->C.jacobian_chainColumns(f1), H2, f2->C.jacobian_chainColumns(f2));
+  return true;
+}
+
 //===========================================================================
 
 void F_PositionRel::phi2(arr& y, arr& J, const FrameL& F) {
@@ -56,6 +85,14 @@ void F_Vector::phi2(arr& y, arr& J, const FrameL& F){
   f->C.kinematicsVec(y, J, f, vec);
 }
 
+bool F_Vector::phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F) {
+  CHECK_EQ(F.N, 1, "");
+  rai::Frame *f = F.elem(0);
+  if(!f->C.hessian_vec(H, f, f->ensure_X().rot*vec, c)) return false;
+  cols = f->C.jacobian_chainColumns(f);
+  return true;
+}
+
 //===========================================================================
 
 void F_VectorDiff::phi2(arr& y, arr& J, const FrameL& F){
@@ -70,6 +107,17 @@ void F_VectorDiff::phi2(arr& y, arr& J, const FrameL& F){
   J -= J2;
 }
 
+bool F_VectorDiff::phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F) {
+  CHECK_EQ(F.N, 2, "");
+  rai::Frame *f1 = F.elem(0);
+  rai::Frame *f2 = F.elem(1);
+  arr H1, H2;
+  if(!f1->C.hessian_vec(H1, f1, f1->ensure_X().rot*vec1, c)) return false;
+  if(!f2->C.hessian_vec(H2, f2, f2->ensure_X().rot*vec2, -c)) return false;
+  catHessians(H, cols, H1, f1->C.jacobian_chainColumns(f1), H2, f2->C.jacobian_chainColumns(f2));
+  return true;
+}
+
 //===========================================================================
 
 void F_VectorRel::phi2(arr& y, arr& J, const FrameL& F){
@@ -110,6 +158,14 @@ void F_Quaternion::phi2(arr& y, arr& J, const FrameL& F){
   f->C.kinematicsQuat(y, J, f);
 }
 
+bool F_Quaternion::phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F) {
+  CHECK_EQ(F.N, 1, "");
+  rai::Frame *f = F.elem(0);
+  if(!f->C.hessian_quat(H, f, c)) return false;
+  cols = f->C.jacobian_chainColumns(f);
+  return true;
+}
+
 //===========================================================================
 
 void F_QuaternionDiff::phi2(arr& y, arr& J, const FrameL& F){
@@ -15,11 +15,13 @@
 struct F_Position : Feature {
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F) { return 3; }
+  virtual bool phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F);
 };
 
 struct F_PositionDiff : Feature {
   virtual arr phi(const FrameL& F);
   virtual uint dim_phi2(const FrameL& F) { return 3; }
+  virtual bool phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F);
 };
 
 struct F_PositionRel : Feature {
@@ -34,6 +36,7 @@ struct F_Vector : Feature {
   F_Vector(const rai::Vector& _vec) : vec(_vec) {}
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F) { return 3; }
+  virtual bool phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F);
 };
 
 struct F_VectorDiff : Feature {
@@ -41,6 +44,7 @@ struct F_VectorDiff : Feature {
   F_VectorDiff(const rai::Vector& _vec1, const rai::Vector& _vec2)  : vec1(_vec1), vec2(_vec2) {}
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F) { return 3; }
+  virtual bool phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F);
 };
 
 struct F_VectorRel: Feature {
@@ -77,6 +81,7 @@ struct F_Quaternion : Feature {
   F_Quaternion(){ flipTargetSignOnNegScalarProduct = true; }
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F) { return 4; }
+  virtual bool phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F);
 };
 
 struct F_QuaternionDiff : Feature {
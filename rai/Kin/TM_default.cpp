@@ -66,7 +66,7 @@ TM_Default::TM_Default(const rai::Node* specs, const rai::Configuration& G)
   :type(TMT_no), i(-1), j(-1) {
   CHECK(specs->parents.N>1, "");
   //  rai::String& tt=specs->parents(0)->key;
-  rai::String& Type=specs->parents(1)->key;
+  const rai::String& Type=specs->parents(1)->key;
   const char* ref1=nullptr, *ref2=nullptr;
   if(specs->parents.N>2) ref1=specs->parents(2)->key.p;
   if(specs->parents.N>3) ref2=specs->parents(3)->key.p;
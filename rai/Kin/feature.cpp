@@ -184,6 +184,22 @@ fct Feature::vf2(const FrameL& F) { ///< direct conversion to vector function: u
 //  };
 //}
 
+/// pulls the weights c back through the linear transformation (scale, target) and calls phi2_H; only for order 0
+bool Feature::evalHessian(arr& H, uintA& cols, const arr& c, const FrameL& F) {
+  if(order>0) return false; //Hessians of finite differences over time slices are not supported
+  arr c0 = c;
+  if(scale.N) {
+    if(scale.N==1) c0 *= scale.scalar();
+    else if(scale.nd==1) c0 = scale % c;
+    else if(scale.nd==2) c0 = ~scale * c;
+  }
+  if(target.N && flipTargetSignOnNegScalarProduct) {
+    arr y = phi(F);
+    if(scalarProduct(y, target)<-.0) c0 *= -1.;
+  }
+  return phi2_H(H, cols, c0, F);
+}
+
 void Feature::applyLinearTrans(arr& y) {
   if(target.N) {
     if(flipTargetSignOnNegScalarProduct) {
@@ -43,12 +43,14 @@ protected:
   virtual arr phi(const FrameL& F);
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F) {  NIY; }
+  virtual bool phi2_H(arr& H, uintA& cols, const arr& c, const FrameL& F) { return false; } ///< optional exact Hessian of phi, see evalHessian
 
  public:
   arr eval(const FrameL& F) { arr y = phi(F); applyLinearTrans(y); return y; }
 //  Value eval(const FrameL& F) { arr y, J; eval(y, J, F); return Value(y, J); }
   arr eval(const rai::Configuration& C) { return eval(getFrames(C)); }
   uint dim(const FrameL& F) { uint d=dim_phi2(F); return applyLinearTrans_dim(d); }
+  bool evalHessian(arr& H, uintA& cols, const arr& c, const FrameL& F); ///< H = sum_i c_i d^2 y_i/dqdq for y=eval(F), as (cols.N,cols.N)-block over the joint state columns cols; false if not available
   fct vf2(const FrameL& F);
 
   virtual rai::String shortTag(const rai::Configuration& C);
@@ -14,6 +14,7 @@
 #include "../Geo/signedDistanceFunctions.h"
 
 #include <climits>
+#include <algorithm>
 
 #ifdef RAI_GL
 #include "../Gui/opengl.h"
@@ -47,20 +48,43 @@ void rai::Transformation_Qtoken::operator=(const rai::Transformation& _Q) { f.Q=
 
 bool rai_Kin_frame_ignoreQuatNormalizationWarning = false;
 
+/// insert f into the frameIndex of its configuration, keeping the bucket sorted by ID
+static void frameIndexAdd(rai::Frame* f) {
+  if(!f->C._state_frameIndex_isGood) return;
+  FrameL& bucket = f->C.frameIndex[f->name.p?f->name.p:""];
+  if(!bucket.N || bucket.elem(-1)->ID<f->ID) { bucket.append(f); return; }
+  rai::Frame** pos = std::lower_bound(bucket.p, bucket.p+bucket.N, f, [](rai::Frame* a, rai::Frame* b) { return a->ID<b->ID; });
+  bucket.insert(pos-bucket.p, f);
+}
+
+/// remove f from the frameIndex of its configuration
+static void frameIndexRemove(rai::Frame* f) {
+  if(!f->C._state_frameIndex_isGood) return;
+  auto it = f->C.frameIndex.find(f->name.p?f->name.p:"");
+  CHECK(it!=f->C.frameIndex.end(), "frame '" <<f->name <<"' is not in the frameIndex");
+  FrameL& bucket = it->second;
+  if(bucket.N && bucket.elem(-1)==f) bucket.resizeCopy(bucket.N-1);
+  else bucket.removeValue(f);
+  if(!bucket.N) f->C.frameIndex.erase(it);
+}
+
 rai::Frame::Frame(Configuration& _C, const Frame* copyFrame)
   : C(_C) {
 
   ID=C.frames.N;
   C.frames.append(this);
+  C._flatOrder.clear();
+  C._state_flatX_isGood=false;
   if(copyFrame) {
     const Frame& f = *copyFrame;
-    name=f.name; Q=f.Q; X=f.X; _state_X_isGood=f._state_X_isGood; tau=f.tau; ats=f.ats;
+    (String&)name=f.name; Q=f.Q; X=f.X; _state_X_isGood=f._state_X_isGood; tau=f.tau; ats=f.ats;
     //we cannot copy link! because we can't know if the frames already exist. Configuration::copy copies the rel's !!
     if(copyFrame->joint) new Joint(*this, copyFrame->joint);
     if(copyFrame->shape) new Shape(*this, copyFrame->shape);
     if(copyFrame->inertia) new Inertia(*this, copyFrame->inertia);
     if(copyFrame->particleDofs) new ParticleDofs(*this, copyFrame->particleDofs);
   }
+  frameIndexAdd(this);
 }
 
 rai::Frame::Frame(Frame* _parent)
@@ -77,6 +101,7 @@ rai::Frame::~Frame() {
   if(inertia) delete inertia;
   if(parent) unLink();
   while(children.N) children.last()->unLink();
+  frameIndexRemove(this);
   if(this==C.frames.last()) { //great: this is very efficient to remove without breaking indexing
     CHECK_EQ(ID, C.frames.N-1, "");
     C.frames.resizeCopy(C.frames.N-1);
@@ -88,6 +113,13 @@ rai::Frame::~Frame() {
   C.reset_q();
 }
 
+rai::Frame& rai::Frame::setName(const char* _name) {
+  frameIndexRemove(this);
+  (String&)name = _name;
+  frameIndexAdd(this);
+  return *this;
+}
+
 void rai::Frame::calc_X_from_parent() {
   CHECK(parent, "");
   CHECK(parent->_state_X_isGood, "");
@@ -97,19 +129,23 @@ void rai::Frame::calc_X_from_parent() {
   X = from;
   X.appendTransformation(Q);
   CHECK_EQ(X.pos.x, X.pos.x, "NAN transformation:" <<from <<'*' <<Q);
-  if(joint) {
-    Joint* j = joint;
-    if(j->type==JT_hingeX || j->type==JT_transX || j->type==JT_XBall)  j->axis = from.rot.getX();
-    if(j->type==JT_hingeY || j->type==JT_transY)  j->axis = from.rot.getY();
-    if(j->type==JT_hingeZ || j->type==JT_transZ)  j->axis = from.rot.getZ();
-    if(j->type==JT_transXYPhi || j->type==JT_transYPhi)  j->axis = from.rot.getZ();
-    if(j->type==JT_phiTransXY)  j->axis = from.rot.getZ();
-  }
+  calc_jointAxis_from_parent();
 
   _state_X_isGood=true;
   C._state_proxies_isGood = false;
 }
 
+void rai::Frame::calc_jointAxis_from_parent() {
+  if(!joint) return;
+  Joint* j = joint;
+  const Quaternion& rot = parent->X.rot;
+  if(j->type==JT_hingeX || j->type==JT_transX || j->type==JT_XBall)  j->axis = rot.getX();
+  if(j->type==JT_hingeY || j->type==JT_transY)  j->axis = rot.getY();
+  if(j->type==JT_hingeZ || j->type==JT_transZ)  j->axis = rot.getZ();
+  if(j->type==JT_transXYPhi || j->type==JT_transYPhi)  j->axis = rot.getZ();
+  if(j->type==JT_phiTransXY)  j->axis = rot.getZ();
+}
+
 void rai::Frame::calc_Q_from_parent(bool enforceWithinJoint) {
   CHECK(parent, "");
   CHECK(_state_X_isGood, "");
@@ -266,7 +302,7 @@ rai::Dof* rai::Frame::getDof() const {
 void rai::Frame::prefixSubtree(const char* prefix) {
   FrameL F = {this};
   getSubtree(F);
-  for(auto* f:F) f->name.prepend(prefix);
+  for(auto* f:F) f->setName(STRING(prefix <<f->name));
 
 }
 
@@ -308,6 +344,7 @@ void rai::Frame::transformToDiagInertia(){
 }
 
 void rai::Frame::_state_setXBadinBranch() {
+  C._state_flatX_isGood=false;
   if(_state_X_isGood) { //no need to propagate to children if already bad
     _state_X_isGood=false;
     for(Frame* child:children) child->_state_setXBadinBranch();
@@ -336,12 +373,12 @@ void rai::Frame::read(const Graph& ats) {
     set_Q()->rot.normalize();
   }
 
-  if(ats["type"]) ats["type"]->key = "shape"; //compatibility with old convention: 'body { type... }' generates shape
+  if(ats["type"]) ats["type"]->setKey("shape"); //compatibility with old convention: 'body { type... }' generates shape
 
   if((n=ats["joint"])) {
     if(ats["B"]) { //there is an extra transform from the joint into this frame -> create an own joint frame
       Frame* f = new Frame(parent);
-      f->name <<'|' <<name; //the joint frame is actually the link frame of all child frames
+      f->setName(STRING('|' <<name)); //the joint frame is actually the link frame of all child frames
       this->unLink();
       this->setParent(f, false);
       new Joint(*f);
@@ -595,13 +632,14 @@ rai::Frame* rai::Frame::insertPreLink(const rai::Transformation& A) {
   if(parent) {
     f = new Frame(parent);
     parent->children.removeValue(this);
-    f->name <<parent->name <<'>' <<name;
+    f->setName(STRING(parent->name <<'>' <<name));
   } else {
     f = new Frame(C);
-    f->name <<"NIL>" <<name;
+    f->setName(STRING("NIL>" <<name));
   }
   parent=f;
   parent->children.append(this);
+  C._state_updateAfterRelinking();
 
   if(!!A) f->Q=A; else f->Q.setZero();
   f->_state_updateAfterTouchingQ();
@@ -612,11 +650,12 @@ rai::Frame* rai::Frame::insertPreLink(const rai::Transformation& A) {
 rai::Frame* rai::Frame::insertPostLink(const rai::Transformation& B) {
   //new frame between: parent -> this -> f
   Frame* f = new Frame(C);
-  if(name) f->name <<'<' <<name;
+  if(name) f->setName(STRING('<' <<name));
 
   //reconnect all outlinks from -> to
   f->children = children;
   for(Frame* b:children) b->parent = f;
+  C._state_updateAfterRelinking();
   children.clear();
 
   f->setParent(this, false);
@@ -633,6 +672,7 @@ void rai::Frame::unLink() {
   parent->children.removeValue(this);
   parent=nullptr;
   Q.setZero();
+  C._state_updateAfterRelinking();
   if(joint) {  delete joint;  joint=nullptr;  }
 }
 
@@ -653,6 +693,7 @@ rai::Frame& rai::Frame::setParent(rai::Frame* _parent, bool keepAbsolutePose_and
 
   parent=_parent;
   parent->children.append(this);
+  C._state_updateAfterRelinking();
 
   if(keepAbsolutePose_and_adaptRelativePose) calc_Q_from_parent();
   _state_updateAfterTouchingQ();
@@ -1419,8 +1460,8 @@ void rai::Shape::read(const Graph& ats) {
       read_ppm(mesh().texImg, fil.name, true);
 //      cout <<"TEXTURE: " <<mesh().texImg.dim() <<endl;
     }
-    if(ats.get(str, "sdf"))      { sdf().read(FILE(str)); }
-    else if(ats.get(fil, "sdf")) { sdf().read(fil); }
+    if(ats.get(str, "sdf"))      { sdf().readFile(str); }
+    else if(ats.get(fil, "sdf")) { sdf().readFile(fil.absolutePathName()); }
     if(_sdf){
       if(size.N){
         if(size.N==1){ sdf().lo *= size.elem(); sdf().up *= size.elem(); }
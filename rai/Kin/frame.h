@@ -37,6 +37,17 @@ typedef rai::Array<rai::Joint*> JointL;
 typedef rai::Array<rai::Dof*> DofL;
 typedef rai::Array<rai::Shape*> ShapeL;
 
+namespace rai {
+/// an active joint on the chain from a frame to the root, flattened for the Jacobian loops (cached by Configuration::jacobian_chain)
+struct ChainLink {
+  Joint* joint;
+  JointType type;
+  uint qIndex; ///< first column in the joint state
+  uint local;  ///< first column in the frame's chain columns (the dense block of sparse Jacobians)
+};
+}
+typedef rai::Array<rai::ChainLink> ChainLinkA;
+
 extern rai::Frame& NoFrame;
 //extern rai::Shape& NoShape;
 //extern rai::Joint& NoJoint;
@@ -72,7 +83,7 @@ struct Transformation_Qtoken {
 struct Frame : NonCopyable {
   Configuration& C;        ///< a Frame is uniquely associated with a Configuration
   uint ID;                 ///< unique identifier (index in Configuration.frames)
-  String name;             ///< name
+  const String name;       ///< name -- change via setName only
   Frame* parent=nullptr;   ///< parent frame
   FrameL children;         ///< list of children
   Frame* prev=0;           ///< same frame in the previous time slice - if time sliced
@@ -82,12 +93,16 @@ struct Frame : NonCopyable {
   Transformation X=0;        ///< frame's absolute pose
   //data structure state (lazy evaluation leave the state structure out of sync)
   bool _state_X_isGood=true; // X represents the current state
+  ChainLinkA _chain; // the active joints from here to the root, in chain order (cached by Configuration::jacobian_chain)
+  uintA _chainColumns; // their q-columns: the sparsity pattern of this frame's Jacobians
+  uint _chain_revision=0; // the C._chainRevision for which _chain was computed
   void _state_setXBadinBranch();
   void _state_updateAfterTouchingX();
   void _state_updateAfterTouchingQ();
   //low-level fwd kinematics computation
   void calc_X_from_parent();
   void calc_Q_from_parent(bool enforceWithinJoint = true);
+  void calc_jointAxis_from_parent(); //the world axis of (1D and planar) joints, after the parent's X changed
 
  public:
   double tau=0.;              ///< frame's relative time transformation (could be thought as part of the transformation X in space-time)
@@ -112,10 +127,12 @@ struct Frame : NonCopyable {
   const Transformation& ensure_X();
   const Transformation& get_Q() const;
   const Transformation& get_X() const;
+  bool isXgood() const { return _state_X_isGood; } ///< X is up to date (otherwise ensure_X recomputes it)
   Transformation_Xtoken set_X() { return Transformation_Xtoken(*this); }
   Transformation_Qtoken set_Q() { return Transformation_Qtoken(*this); }
 
   //structural operations
+  Frame& setName(const char* _name); ///< change the name (keeps the C.frameIndex valid)
   Frame& setParent(Frame* _parent, bool keepAbsolutePose_and_adaptRelativePose=false, bool checkForLoop=false);
   void unLink();
   Frame* insertPreLink(const rai::Transformation& A=0);
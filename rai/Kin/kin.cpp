@@ -20,6 +20,8 @@
 #include "viewer.h"
 #include "../Core/graph.h"
 #include "../Core/util.h"
+#include "../Core/profile.h"
+#include "../Core/thread.h"
 #include "../Geo/fclInterface.h"
 #include "../Geo/qhull.h"
 #include "../Geo/mesh_readAssimp.h"
@@ -29,6 +31,7 @@
 #include <algorithm>
 #include <sstream>
 #include <climits>
+#include <sys/stat.h>
 
 #ifdef RAI_ASSIMP
 #  include <assimp/Exporter.hpp>
@@ -143,10 +146,60 @@ Configuration::~Configuration() {
   self.reset();
 }
 
-/// make this a copy of C (copying all frames, forces & proxies)
+/** @brief make this a copy of C (copying all frames, forces & proxies). The copy is always deep; if this has the same
+    structure as C (see hasSameStructure), it is an in-place recopy that overwrites the data of the existing frames
+    instead of rebuilding them -- the cost is still linear in the number of frames, nothing is shared with C */
 void Configuration::copy(const Configuration& C, bool referenceSwiftOnCopy) {
   CHECK(this != &C, "never copy C onto itself");
 
+  //in-place recopy, e.g. copying the same scene again (viewers, controllers): overwrite the existing frames' data
+  if(hasSameStructure(C)) {
+    jacMode = C.jacMode;
+    reset_q();
+    for(uint i=0; i<frames.N; i++) {
+      Frame* f = frames.elem(i);
+      const Frame* c = C.frames.elem(i);
+      f->Q=c->Q; f->X=c->X; f->_state_X_isGood=c->_state_X_isGood; f->tau=c->tau; f->ats=c->ats;
+      if(c->joint) {
+        Joint* j = f->joint;
+        const Joint* cj = c->joint;
+        j->qIndex=cj->qIndex; j->dim=cj->dim;
+        j->axis=cj->axis; j->limits=cj->limits; j->q0=cj->q0; j->H=cj->H; j->scale=cj->scale;
+        j->active=cj->active;
+        j->isStable=cj->isStable;
+        j->sampleUniform=cj->sampleUniform;  j->sampleSdv=cj->sampleSdv;
+        j->code=cj->code;
+      }
+      if(c->shape) {
+        Shape* sh = f->shape;
+        const Shape* cs = c->shape;
+        sh->_mesh=cs->_mesh; sh->_sscCore=cs->_sscCore; sh->_sdf=cs->_sdf; //shallow shared_ptr copies, as in the Shape copy constructor
+        sh->_type=cs->_type;
+        sh->size=cs->size;
+        sh->cont=cs->cont;
+      }
+      if(c->inertia) {
+        f->inertia->mass=c->inertia->mass; f->inertia->matrix=c->inertia->matrix;
+        f->inertia->type=c->inertia->type; f->inertia->com=c->inertia->com;
+      }
+    }
+    //children in ID order, as setParent creates them when copying all frames
+    for(Frame* f:frames) if(f->children.N>1) std::sort(f->children.p, f->children.p+f->children.N, [](Frame* a, Frame* b) { return a->ID<b->ID; });
+    _state_flatX_isGood=false;
+    _state_proxies_isGood=false;
+    copyProxies(C.proxies);
+    if(referenceSwiftOnCopy) {
+      self->swift = C.self->swift;
+      self->fcl = C.self->fcl;
+    }
+    q = C.q;
+    qInactive = C.qInactive;
+    _state_q_isGood = C._state_q_isGood;
+    ensure_indexedJoints();
+    if(self->viewer) self->viewer->recopyMeshes(*this); //shapes may have changed, as after clear()
+    return;
+  }
+
   clear();
   jacMode = C.jacMode;
 
@@ -183,11 +236,35 @@ void Configuration::copy(const Configuration& C, bool referenceSwiftOnCopy) {
   ensure_indexedJoints();
 }
 
+/** @brief true if K has the same frames (names, parents, prev links) with the same kinds of attachments (joint types,
+    mimics, shapes, inertias) -- that is, K differs from this only in poses and joint/shape parameters. Configurations
+    with force exchanges, particle dofs or joint uncertainties are never considered the same. */
+bool Configuration::hasSameStructure(const Configuration& K) const {
+  if(frames.N!=K.frames.N || frames.nd!=K.frames.nd || frames.d0!=K.frames.d0) return false;
+  if(otherDofs.N || K.otherDofs.N) return false;
+  for(uint i=0; i<frames.N; i++) {
+    const Frame* f = frames.elem(i);
+    const Frame* k = K.frames.elem(i);
+    if((f->parent?(int)f->parent->ID:-1) != (k->parent?(int)k->parent->ID:-1)) return false;
+    if((f->prev?(int)f->prev->ID:-1) != (k->prev?(int)k->prev->ID:-1)) return false;
+    if(f->name!=k->name) return false;
+    if(f->particleDofs || k->particleDofs) return false;
+    if(!f->joint != !k->joint || !f->shape != !k->shape || !f->inertia != !k->inertia) return false;
+    if(f->joint) {
+      const Joint* a = f->joint;
+      const Joint* b = k->joint;
+      if(a->type!=b->type || a->uncertainty || b->uncertainty) return false;
+      if((a->mimic?(int)a->mimic->frame->ID:-1) != (b->mimic?(int)b->mimic->frame->ID:-1)) return false;
+    }
+  }
+  return true;
+}
+
 bool Configuration::operator!() const { return this==&NoConfiguration; }
 
 Frame* Configuration::addFrame(const char* name, const char* parent, const char* args) {
   Frame* f = new Frame(*this);
-  f->name = name;
+  f->setName(name);
 
   if(parent && parent[0]) {
     Frame* p = getFrame(parent);
@@ -218,6 +295,307 @@ Frame* Configuration::addFile(const char* filename) {
   return frames.elem(n); //returns 1st frame of added file
 }
 
+Frame* Configuration::addFileCached(const char* filename, const char* cacheFile) {
+  String cache;
+  if(cacheFile) cache = cacheFile; else cache <<filename <<".cache";
+  if(!checkCache(cache)) {
+    LOG(1) <<"(re)compiling scene cache '" <<cache <<"' from '" <<filename <<"'";
+    compileCache(filename, cache);
+  }
+  return readCache(cache);
+}
+
+//===========================================================================
+//
+// binary scene cache: the fully resolved frame tree (incl. meshes and sdfs) as column tables in a MappedArrays file
+//
+
+static const int sceneCacheVersion=2;
+
+/// size and modification time [ns] of a file (both 0 if the file does not exist)
+static void fileStat(const char* filename, uint64_t& size, int64_t& mtime) {
+  struct stat st;
+  if(stat(filename, &st)) { size=0; mtime=0; return; }
+  size = st.st_size;
+  mtime = int64_t(st.st_mtim.tv_sec)*1000000000 + st.st_mtim.tv_nsec;
+}
+
+/// FNV-1a hash and size of a file's content (both 0 if the file does not exist)
+static uint64_t fileFingerprint(const char* filename, uint64_t& size) {
+  size=0;
+  std::ifstream fil(filename, std::ios::binary);
+  if(!fil.good()) return 0;
+  uint64_t h=14695981039346656037ull;
+  char buf[1<<16];
+  while(fil) {
+    fil.read(buf, sizeof(buf));
+    std::streamsize n=fil.gcount();
+    for(std::streamsize i=0; i<n; i++) { h ^= (unsigned char)buf[i]; h *= 1099511628211ull; }
+    size += n;
+  }
+  return h;
+}
+
+void Configuration::compileCache(const char* filename, const char* cacheFile) {
+  Configuration C;
+  FileToken file(filename, true);
+  Graph G(file);
+  C.readFromGraph(G);
+  file.cd_start();
+
+  //-- all files the configuration depends on: the file itself, its includes, and meshes, textures, sdfs
+  String dir = file.cwd;
+  if(file.path.N) dir <<'/' <<file.path;
+  StringA sources = { file.absolutePathName() };
+  for(const String& s:G.includedFiles) sources.setAppend(s);
+  for(Frame* f:C.frames) if(f->ats) for(Node* n:*f->ats) {
+    if(n->key!="mesh" && n->key!="texture" && n->key!="sdf") continue;
+    if(n->isOfType<FileToken>()) sources.setAppend(n->get<FileToken>().absolutePathName());
+    else if(n->isOfType<String>()) {
+      const String& s = n->get<String>();
+      if(s.N && s(0)=='/') sources.setAppend(s); else sources.setAppend(STRING(dir <<'/' <<s));
+    }
+  }
+
+  C.writeCache(cacheFile, sources);
+}
+
+bool Configuration::checkCache(const char* cacheFile) {
+  if(!MappedArrays::isMappedFile(cacheFile)) return false;
+  MappedArrays M(cacheFile);
+  if(!M.has("cache.version") || M.get<int>("cache.version").scalar()!=sceneCacheVersion) return false;
+  charA txt = M.get<char>("cache.sources");
+  std::istringstream is(std::string(txt.p, txt.N));
+  uint64_t hash, size, s;
+  int64_t mtime, t;
+  std::string path;
+  while(is >>std::hex >>hash >>std::dec >>size >>mtime) {
+    is.get();
+    std::getline(is, path);
+    fileStat(path.c_str(), s, t);
+    if(s!=size) return false;
+    if(t==mtime) continue; //same size and time: the content is not read
+    if(fileFingerprint(path.c_str(), s)!=hash) return false; //only touched?
+  }
+  return true;
+}
+
+void Configuration::writeCache(const char* cacheFile, const StringA& sourceFiles) const {
+  CHECK(!otherDofs.N, "the scene cache does not support force exchanges");
+  uint N=frames.N;
+  MappedArraysWriter W;
+
+  //-- sources
+  String str;
+  for(const String& s:sourceFiles) {
+    uint64_t size;
+    int64_t mtime;
+    fileStat(s, size, mtime);
+    uint64_t h = fileFingerprint(s, size);
+    str <<std::hex <<h <<std::dec <<' ' <<size <<' ' <<mtime <<' ' <<s <<'\n';
+  }
+  charA sources;
+  sources.append(str.p, str.N);
+  intA version = { sceneCacheVersion };
+  W.add("cache.version", version).add("cache.sources", sources);
+
+  //-- frames: names and attributes are '\0'-separated strings
+  charA names, ats;
+  intA parent(N);
+  arr Q(N, 7), X(N, 7), tau(N);
+  byteA XisGood(N);
+  for(Frame* f:frames) {
+    CHECK(!f->prev && !f->particleDofs, "the scene cache does not support time slices or particle dofs (frame '" <<f->name <<"')");
+    uint i=f->ID;
+    names.append(f->name.p, f->name.N);  names.append(0);
+    str.clear();
+    if(f->ats) f->ats->write(str, ", ", nullptr);
+    ats.append(str.p, str.N);  ats.append(0);
+    parent(i) = f->parent ? f->parent->ID : -1;
+    Q[i] = f->Q.getArr7d();
+    X[i] = f->X.getArr7d();
+    XisGood(i) = f->_state_X_isGood;
+    tau(i) = f->tau;
+  }
+  W.add("frame.names", names).add("frame.ats", ats).add("frame.parent", parent);
+  W.add("frame.Q", Q).add("frame.X", X).add("frame.XisGood", XisGood).add("frame.tau", tau);
+
+  //-- joints: one row per joint; limits and q0 are ragged (offsets into a value list)
+  intA jFrame, jType, jDim, jMimic, jFlags, jLimitsIdx={0}, jQ0Idx={0};
+  arr jParams, jLimits, jQ0;
+  charA jCode;
+  for(Frame* f:frames) if(f->joint) {
+    Joint* j=f->joint;
+    CHECK(!j->uncertainty, "the scene cache does not support joint uncertainties (frame '" <<f->name <<"')");
+    jFrame.append(f->ID);
+    jType.append(j->type);
+    jDim.append(j->dim);
+    jMimic.append(j->mimic ? (int)j->mimic->frame->ID : -1);
+    jFlags.append(j->active + 2*j->isStable);
+    jParams.append({j->axis.x, j->axis.y, j->axis.z, j->H, j->scale, j->sampleUniform, j->sampleSdv});
+    jLimits.append(j->limits);  jLimitsIdx.append(jLimits.N);
+    jQ0.append(j->q0);  jQ0Idx.append(jQ0.N);
+    jCode.append(j->code.p, j->code.N);  jCode.append(0);
+  }
+  jParams.reshape(jFrame.N, 7);
+  W.add("joint.frame", jFrame).add("joint.type", jType).add("joint.dim", jDim).add("joint.mimic", jMimic).add("joint.flags", jFlags);
+  W.add("joint.params", jParams).add("joint.limits", jLimits).add("joint.limitsIdx", jLimitsIdx).add("joint.q0", jQ0).add("joint.q0Idx", jQ0Idx).add("joint.code", jCode);
+
+  //-- shapes: meshes and sdfs are stored once per shared_ptr, so that sharing survives the round trip
+  intA sFrame, sType, sMesh, sCore, sSdf, sSizeIdx={0};
+  byteA sCont;
+  arr sSize;
+  rai::Array<const Mesh*> meshes;
+  rai::Array<const SDF_GridData*> sdfs;
+  auto meshId = [&meshes](const shared_ptr<Mesh>& m) -> int {
+    if(!m) return -1;
+    int i = meshes.findValue(m.get());
+    if(i<0) { i=meshes.N; meshes.append(m.get()); }
+    return i;
+  };
+  for(Frame* f:frames) if(f->shape) {
+    Shape* s=f->shape;
+    sFrame.append(f->ID);
+    sType.append(s->_type);
+    sCont.append(s->cont);
+    sSize.append(s->size);  sSizeIdx.append(sSize.N);
+    sMesh.append(meshId(s->_mesh));
+    sCore.append(meshId(s->_sscCore));
+    int k=-1;
+    if(s->_sdf) {
+      k = sdfs.findValue(s->_sdf.get());
+      if(k<0) { k=sdfs.N; sdfs.append(s->_sdf.get()); }
+    }
+    sSdf.append(k);
+  }
+  W.add("shape.frame", sFrame).add("shape.type", sType).add("shape.cont", sCont).add("shape.size", sSize).add("shape.sizeIdx", sSizeIdx);
+  W.add("shape.mesh", sMesh).add("shape.core", sCore).add("shape.sdf", sSdf);
+  for(uint i=0; i<meshes.N; i++) meshes(i)->writeMapped(W, STRING("mesh" <<i <<'.'));
+  arr sdfPose(sdfs.N, 7);
+  for(uint i=0; i<sdfs.N; i++) {
+    sdfs(i)->writeMapped(W, STRING("sdf" <<i <<'.'));
+    sdfPose[i] = sdfs(i)->pose.getArr7d();
+  }
+  intA counts = { (int)meshes.N, (int)sdfs.N };
+  W.add("mesh.count", counts).add("sdf.pose", sdfPose);
+
+  //-- inertias: mass, com(3), matrix(9) per row
+  intA iFrame, iType;
+  arr iParams;
+  for(Frame* f:frames) if(f->inertia) {
+    Inertia* in=f->inertia;
+    iFrame.append(f->ID);
+    iType.append(in->type);
+    const Matrix& m=in->matrix;
+    iParams.append({in->mass, in->com.x, in->com.y, in->com.z, m.m00, m.m01, m.m02, m.m10, m.m11, m.m12, m.m20, m.m21, m.m22});
+  }
+  iParams.reshape(iFrame.N, 13);
+  W.add("inertia.frame", iFrame).add("inertia.type", iType).add("inertia.params", iParams);
+
+  W.write(cacheFile);
+}
+
+Frame* Configuration::readCache(const char* cacheFile) {
+  auto M = make_shared<MappedArrays>(cacheFile, true);
+  CHECK(M->has("cache.version") && M->get<int>("cache.version").scalar()==sceneCacheVersion, "'" <<cacheFile <<"' is not a scene cache of version " <<sceneCacheVersion);
+  uint n0=frames.N;
+
+  //-- frames: first create all, then link (a parent may have a higher ID)
+  intA parent = M->get<int>("frame.parent");
+  arr Q = M->get<double>("frame.Q"), X = M->get<double>("frame.X"), tau = M->get<double>("frame.tau");
+  byteA XisGood = M->get<byte>("frame.XisGood");
+  charA names = M->get<char>("frame.names"), ats = M->get<char>("frame.ats");
+  const char* name=names.p, *at=ats.p;
+  for(uint i=0; i<parent.N; i++) {
+    Frame* f = new Frame(*this);
+    f->setName(name);  name += strlen(name)+1;
+    if(*at) { f->ats = make_shared<Graph>();  String(at) >>*f->ats; }
+    at += strlen(at)+1;
+    f->tau = tau(i);
+  }
+  for(uint i=0; i<parent.N; i++) {
+    Frame* f = frames.elem(n0+i);
+    if(parent(i)>=0) f->setParent(frames.elem(n0+parent(i)), false, false);
+    f->Q.set(&Q(i, 0));
+    f->X.set(&X(i, 0));
+    f->_state_X_isGood = XisGood(i);
+  }
+
+  //-- joints
+  intA jFrame = M->get<int>("joint.frame"), jType = M->get<int>("joint.type"), jDim = M->get<int>("joint.dim");
+  intA jMimic = M->get<int>("joint.mimic"), jFlags = M->get<int>("joint.flags");
+  intA jLimitsIdx = M->get<int>("joint.limitsIdx"), jQ0Idx = M->get<int>("joint.q0Idx");
+  arr jParams = M->get<double>("joint.params"), jLimits = M->get<double>("joint.limits"), jQ0 = M->get<double>("joint.q0");
+  charA jCode = M->get<char>("joint.code");
+  const char* code=jCode.p;
+  for(uint i=0; i<jFrame.N; i++) {
+    Frame& f = *frames.elem(n0+jFrame(i));
+    JointType type = (JointType)jType(i);
+    Joint* j;
+    if(type==JT_generic) { j = new Joint(f);  j->setGeneric(code); }
+    else j = new Joint(f, type);
+    code += strlen(code)+1;
+    CHECK_EQ(j->dim, (uint)jDim(i), "joint of frame '" <<f.name <<"' has a different dimension than in the cache");
+    j->setActive(jFlags(i)&1);
+    j->isStable = jFlags(i)&2;
+    const double* p = &jParams(i, 0);
+    j->axis.set(p[0], p[1], p[2]);
+    j->H=p[3];  j->scale=p[4];  j->sampleUniform=p[5];  j->sampleSdv=p[6];
+    j->limits.setCarray(jLimits.p+jLimitsIdx(i), jLimitsIdx(i+1)-jLimitsIdx(i));
+    j->q0.setCarray(jQ0.p+jQ0Idx(i), jQ0Idx(i+1)-jQ0Idx(i));
+  }
+  for(uint i=0; i<jFrame.N; i++) if(jMimic(i)>=0) {
+    frames.elem(n0+jFrame(i))->joint->setMimic(frames.elem(n0+jMimic(i))->joint);
+  }
+
+  //-- meshes (copied: shapes own and modify them) and sdfs (zero-copy: they refer into the mapping)
+  intA counts = M->get<int>("mesh.count");
+  arr sdfPose = M->get<double>("sdf.pose");
+  rai::Array<shared_ptr<Mesh>> meshes(counts(0));
+  for(uint i=0; i<meshes.N; i++) {
+    meshes(i) = make_shared<Mesh>();
+    meshes(i)->readMapped(*M, STRING("mesh" <<i <<'.'));
+  }
+  rai::Array<shared_ptr<SDF_GridData>> sdfs(counts(1));
+  for(uint i=0; i<sdfs.N; i++) {
+    sdfs(i) = make_shared<SDF_GridData>();
+    sdfs(i)->readMapped(M, STRING("sdf" <<i <<'.'));
+    sdfs(i)->pose.set(&sdfPose(i, 0));
+  }
+
+  //-- shapes
+  intA sFrame = M->get<int>("shape.frame"), sType = M->get<int>("shape.type"), sSizeIdx = M->get<int>("shape.sizeIdx");
+  intA sMesh = M->get<int>("shape.mesh"), sCore = M->get<int>("shape.core"), sSdf = M->get<int>("shape.sdf");
+  byteA sCont = M->get<byte>("shape.cont");
+  arr sSize = M->get<double>("shape.size");
+  for(uint i=0; i<sFrame.N; i++) {
+    Shape* s = new Shape(*frames.elem(n0+sFrame(i)));
+    s->_type = (ShapeType)sType(i);
+    s->cont = sCont(i);
+    s->size.setCarray(sSize.p+sSizeIdx(i), sSizeIdx(i+1)-sSizeIdx(i));
+    if(sMesh(i)>=0) s->_mesh = meshes(sMesh(i)); else s->_mesh.reset();
+    if(sCore(i)>=0) s->_sscCore = meshes(sCore(i));
+    if(sSdf(i)>=0) s->_sdf = sdfs(sSdf(i));
+  }
+
+  //-- inertias
+  intA iFrame = M->get<int>("inertia.frame"), iType = M->get<int>("inertia.type");
+  arr iParams = M->get<double>("inertia.params");
+  for(uint i=0; i<iFrame.N; i++) {
+    Inertia* in = new Inertia(*frames.elem(n0+iFrame(i)));
+    in->type = (BodyType)iType(i);
+    const double* p = &iParams(i, 0);
+    in->mass = p[0];
+    in->com.set(p[1], p[2], p[3]);
+    Matrix& m=in->matrix;
+    m.m00=p[4]; m.m01=p[5]; m.m02=p[6]; m.m10=p[7]; m.m11=p[8]; m.m12=p[9]; m.m20=p[10]; m.m21=p[11]; m.m22=p[12];
+  }
+
+  ensure_indexedJoints();
+  if(frames.N==n0) return 0;
+  return frames.elem(n0);
+}
+
 Frame* Configuration::addAssimp(const char* filename) {
   AssimpLoader A(filename, true, true);
   //-- create all frames
@@ -371,15 +749,21 @@ void Configuration::addConfiguration(const Configuration& C, double tau){
 
 /// get first frame with given name
 Frame* Configuration::getFrame(const char* name, bool warnIfNotExist, bool reverse) const {
-  if(!reverse) {
-    for(Frame* b: frames) if(b->name==name) return b;
-  } else {
-    for(uint i=frames.N; i--;) if(frames.elem(i)->name==name) return frames.elem(i);
-  }
+  Frame* f = ((Configuration*)this)->findIndexedFrame(name, -1, reverse);
+  if(f) return f;
   if(warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"'");
   return 0;
 }
 
+Frame* Configuration::getFrameInSlice(const char* name, uint s, bool warnIfNotExist) const {
+  CHECK_EQ(frames.nd, 2, "configuration is not time sliced");
+  CHECK(s<frames.d0, "slice " <<s <<" out of range");
+  Frame* f = ((Configuration*)this)->findIndexedFrame(name, s);
+  if(f) return f;
+  if(warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"' in slice " <<s);
+  return 0;
+}
+
 /// get all frames of given indices (almost same as \ref frames . Array::sub() )
 FrameL Configuration::getFrames(const uintA& ids) const {
   FrameL F;
@@ -597,6 +981,12 @@ arr Configuration::getDofState(const DofL& dofs) const {
   return x;
 }
 
+/// get the (frames.N,7)-matrix of all poses
+arr Configuration::getFrameState() const {
+  //like Frame::ensure_X on the const frames, this only updates the (mirrored) pose cache
+  return const_cast<Configuration*>(this)->ensure_flatX();
+}
+
 /// get the (F.N,7)-matrix of all poses for all given frames
 arr Configuration::getFrameState(const FrameL& F) const {
   arr X(F.N, 7);
@@ -618,12 +1008,24 @@ void Configuration::setJointState(const arr& _q) {
   CHECK_EQ(_q.N, N, "wrong joint state dimensionalities");
 #endif
 
-  q=_q;
-
   proxies.clear();
+  _state_proxies_isGood=false;
+
+  if(_state_q_isGood && _state_indexedJoints_areGood && q.N==_q.N) {
+    //incremental: q and all Q are consistent -> only touch dofs whose entries changed (setDofs invalidates their branches and mimicers)
+    DofL changed;
+    for(Dof* j:activeDofs) {
+      for(uint i=j->qIndex; i<j->qIndex+j->dim; i++) if(q.p[i]!=_q.p[i]) { changed.append(j); break; }
+    }
+    if(!changed.N) return;
+    memmove(q.p, _q.p, q.N*sizeof(double));
+    for(Dof* j:changed) j->setDofs(q, j->qIndex);
+    return;
+  }
+
+  q=_q;
 
   _state_q_isGood=true;
-  _state_proxies_isGood=false;
   for(Dof* j:activeDofs) {
     if(j->joint() && j->joint()->type!=JT_tau) {
       j->frame->_state_setXBadinBranch();
@@ -1030,6 +1432,8 @@ void Configuration::reset_q() {
 
   _state_indexedJoints_areGood=false;
   _state_q_isGood=false;
+  _state_flatX_isGood=false;
+  _state_updateAfterRelinking();
 }
 
 /** @brief re-orient all joints (edges) such that n becomes
@@ -1107,6 +1511,7 @@ void Configuration::reconnectLinksToClosestJoints() {
           link->children.append(f);
           f->parent = link;
           f->set_Q() = Q;
+          _state_updateAfterRelinking();
         }
       }
     }
@@ -1136,6 +1541,9 @@ void Configuration::sortFrames() {
   frames = calc_topSort();
   uint i=0;
   for(Frame* f: frames) f->ID = i++;
+  _state_frameIndex_isGood=false;
+  _flatOrder.clear();
+  _state_flatX_isGood=false;
 }
 
 void Configuration::makeObjectsFree(const StringA& objects, double H_cost) {
@@ -1211,6 +1619,11 @@ bool Configuration::checkConsistency() const {
     if(a->inertia) CHECK_EQ(&a->inertia->frame, a, "");
     if(a->ats) a->ats->checkConsistency();
 
+    if(_state_frameIndex_isGood) {
+      auto it = frameIndex.find(a->name.p?a->name.p:"");
+      CHECK(it!=frameIndex.end() && it->second.contains(a), "frame '" <<a->name <<"' is not in the frameIndex -- was the name changed without setName?");
+    }
+
     a->Q.checkNan();
     a->X.checkNan();
     CHECK_ZERO(a->Q.rot.normalization()-1., 1e-6, "");
@@ -1405,8 +1818,141 @@ FrameL Configuration::getCollisionAllPairs(){
 
 /// creates uniques names by prefixing the node-index-number to each name */
 void Configuration::prefixNames(bool clear) {
-  if(!clear) for(Frame* a: frames) a->name=STRING('_' <<a->ID <<'_' <<a->name);
-  else       for(Frame* a: frames) a->name.clear() <<a->ID;
+  if(!clear) for(Frame* a: frames) a->setName(STRING('_' <<a->ID <<'_' <<a->name));
+  else       for(Frame* a: frames) a->setName(STRING(a->ID));
+}
+
+/* The frameIndex maps each name to its frames, sorted by ID -- e.g., the same
+   frame in all time slices of a path configuration. Names only change via
+   Frame::setName, so a miss in the index is a miss in the configuration. */
+
+void Configuration::calc_frameIndex() {
+  frameIndex.clear();
+  for(Frame* f: frames) frameIndex[f->name.p?f->name.p:""].append(f);
+  _state_frameIndex_isGood=true;
+}
+
+/// sorts all frames by their depth in the tree (stable w.r.t. a topological order), so that each level only depends on previous ones
+void Configuration::calc_flatOrder() {
+  FrameL topo = check_topSort() ? frames : calc_topSort();
+  uint N=frames.N;
+  uintA depth(N), pos(N);
+  uint maxDepth=0;
+  for(Frame* f:topo) {
+    uint d = f->parent ? depth(f->parent->ID)+1 : 0;
+    depth(f->ID)=d;
+    if(d>maxDepth) maxDepth=d;
+  }
+  _flatLevels.resize(maxDepth+2).setZero();
+  for(Frame* f:topo) _flatLevels(depth(f->ID)+1)++;
+  for(uint d=1; d<_flatLevels.N; d++) _flatLevels(d) += _flatLevels(d-1);
+  uintA next = _flatLevels;
+  _flatOrder.resize(N);
+  for(Frame* f:topo) {
+    uint i = next(depth(f->ID))++;
+    _flatOrder.elem(i)=f;
+    pos(f->ID)=i;
+  }
+  _flatParent.resize(N);
+  for(uint i=0; i<N; i++) {
+    Frame* f=_flatOrder.elem(i);
+    _flatParent.elem(i) = f->parent ? (int)pos(f->parent->ID) : -1;
+  }
+  _state_flatX_isGood=false;
+}
+
+/// column i of the (7,N) struct-of-arrays S becomes [pos, quat] of T
+static void flatSet(arr& S, uint i, const Transformation& T) {
+  uint N=S.d1;
+  double* s=S.p+i;
+  if(T.pos.isZero) { s[0]=s[N]=s[2*N]=0.; }
+  else { s[0]=T.pos.x;  s[N]=T.pos.y;  s[2*N]=T.pos.z; }
+  if(T.rot.isZero) { s[3*N]=1.;  s[4*N]=s[5*N]=s[6*N]=0.; }
+  else { s[3*N]=T.rot.w;  s[4*N]=T.rot.x;  s[5*N]=T.rot.y;  s[6*N]=T.rot.z; }
+}
+
+/** @brief computes the poses X of all frames and mirrors them into the contiguous
+    (frames.N,7)-array _flatX (rows [pos, quat] indexed by frame ID). Instead of recursing
+    up the parent pointers per frame (as Frame::ensure_X does), the poses are gathered into
+    struct-of-arrays (_flatXs for good frames, _flatQs for bad ones) and the bad frames are
+    computed in one sweep over these arrays, level by level in depth: within a level all
+    frames are independent (their parents are in earlier levels), and the inner loop is
+    the plain arithmetic of Transformation::appendTransformation on contiguous rows. The
+    results are written back into the frames (incl. tau and joint axes, as by
+    calc_X_from_parent). Subsequent calls are free until some frame's X becomes bad again. */
+const arr& Configuration::ensure_flatX() {
+  if(_state_flatX_isGood && _flatOrder.N==frames.N && _flatX.d0==frames.N) return _flatX;
+  if(_flatOrder.N!=frames.N) calc_flatOrder();
+  uint N=frames.N;
+
+  //-- gather: X of the good frames (incl. all roots), Q of the bad ones
+  _flatXs.resize(7, N);
+  _flatQs.resize(7, N);
+  uintA bad(N);
+  uint nBad=0;
+  for(uint i=0; i<N; i++) {
+    Frame* f=_flatOrder.elem(i);
+    if(f->_state_X_isGood || !f->parent) flatSet(_flatXs, i, f->X);
+    else { flatSet(_flatQs, i, f->Q);  bad.p[nBad++]=i; }
+  }
+
+  //-- sweep: X = X_parent * Q for the bad frames, one level at a time
+  double *px=_flatXs.p, *py=px+N, *pz=py+N, *qw=pz+N, *qx=qw+N, *qy=qx+N, *qz=qy+N;
+  const double *rx=_flatQs.p, *ry=rx+N, *rz=ry+N, *sw=rz+N, *sx=sw+N, *sy=sx+N, *sz=sy+N;
+  const int* parent=_flatParent.p;
+  const uint* idx=bad.p;
+  for(uint k=0, d=0; k<nBad;) {
+    while(_flatLevels.elem(d+1)<=idx[k]) d++;
+    uint kEnd=k;
+    while(kEnd<nBad && idx[kEnd]<_flatLevels.elem(d+1)) kEnd++;
+#pragma omp simd
+    for(uint l=k; l<kEnd; l++) {
+      uint i=idx[l], p=parent[i];
+      double w=qw[p], a=qx[p], b=qy[p], c=qz[p];
+      double a2=2.*a, b2=2.*b, c2=2.*c;
+      double q11=a*a2, q22=b*b2, q33=c*c2, q12=a*b2, q13=a*c2, q23=b*c2, q01=w*a2, q02=w*b2, q03=w*c2;
+      px[i] = px[p] + (1.-q22-q33)*rx[i] + (q12-q03)*ry[i] + (q13+q02)*rz[i];
+      py[i] = py[p] + (q12+q03)*rx[i] + (1.-q11-q33)*ry[i] + (q23-q01)*rz[i];
+      pz[i] = pz[p] + (q13-q02)*rx[i] + (q23+q01)*ry[i] + (1.-q11-q22)*rz[i];
+      qw[i] = w*sw[i] - a*sx[i] - b*sy[i] - c*sz[i];
+      qx[i] = a*sw[i] + w*sx[i] - c*sy[i] + b*sz[i];
+      qy[i] = b*sw[i] + c*sx[i] + w*sy[i] - a*sz[i];
+      qz[i] = c*sw[i] - b*sx[i] + a*sy[i] + w*sz[i];
+    }
+    k=kEnd;
+  }
+
+  //-- scatter: write back into the bad frames (parents first), and mirror all into _flatX
+  for(uint k=0; k<nBad; k++) {
+    uint i=idx[k];
+    Frame* f=_flatOrder.elem(i);
+    f->X.pos.set(px[i], py[i], pz[i]);
+    f->X.rot.set(qw[i], qx[i], qy[i], qz[i]);
+    f->tau = f->parent->tau;
+    f->calc_jointAxis_from_parent();
+    f->_state_X_isGood=true;
+  }
+  if(nBad) _state_proxies_isGood=false;
+  _flatX.resize(N, 7);
+  for(uint i=0; i<N; i++) {
+    double* x=_flatX.p+7*_flatOrder.elem(i)->ID;
+    for(uint c=0; c<7; c++) x[c]=_flatXs.p[c*N+i];
+  }
+  _state_flatX_isGood=true;
+  return _flatX;
+}
+
+Frame* Configuration::findIndexedFrame(const char* name, int slice, bool reverse) {
+  if(!name) name="";
+  ensure_frameIndex();
+  auto it = frameIndex.find(name);
+  if(it==frameIndex.end()) return nullptr;
+  const FrameL& bucket = it->second;
+  if(slice<0) return reverse ? bucket.elem(-1) : bucket.elem(0);
+  uint lo=slice*frames.d1;
+  Frame** pf = std::lower_bound(bucket.p, bucket.p+bucket.N, lo, [](Frame* f, uint id) { return f->ID<id; });
+  if(pf==bucket.p+bucket.N || (*pf)->ID>=lo+frames.d1) return nullptr; //no frame of this name in the slice
+  return *pf;
 }
 
 void Configuration::calc_indexedActiveJoints(bool resetActiveJointSet) {
@@ -1468,6 +2014,8 @@ void Configuration::calc_indexedActiveJoints(bool resetActiveJointSet) {
 
   //-- resize qInactive
   qInactive.resize(qcount).setZero();
+
+  _chainRevision++; //the qIndex's changed
 }
 
 
@@ -1615,6 +2163,72 @@ void Configuration::kinematicsZero(arr& y, arr& J, uint n) const {
   jacobian_zero(J, n);
 }
 
+/** @brief the active joints (with dofs in the joint state) on the chain from a to the root, in
+    chain order, with their types and columns -- cached in the frame until joints are reindexed,
+    retyped or frames relinked, so that Jacobian loops don't need to walk and test all frames up
+    to the root. (Axes and poses depend on the state and are still read from the joints.) */
+const ChainLinkA& Configuration::jacobian_chain(Frame* a) const {
+  uint N=getJointStateDimension(); //ensures the joint indexing (which may increment _chainRevision)
+  if(a->_chain_revision==_chainRevision) return a->_chain;
+  a->_chain.clear();
+  a->_chainColumns.clear();
+  for(Frame* f=a; f->parent; f=f->parent) {
+    Joint* j=f->joint;
+    if(!j || !j->active) continue;
+    CHECK_LE(j->qIndex, q.N, "");
+    if(j->qIndex>=N) { CHECK_EQ(j->type, JT_rigid, ""); continue; }
+    if(!j->dim) continue;
+    a->_chain.append({j, j->type, j->qIndex, a->_chainColumns.N});
+    for(uint i=0; i<j->dim; i++) a->_chainColumns.append(j->qIndex+i);
+  }
+  a->_chain_revision=_chainRevision;
+  return a->_chain;
+}
+
+const uintA& Configuration::jacobian_chainColumns(Frame* a) const {
+  jacobian_chain(a);
+  return a->_chainColumns;
+}
+
+/// for sparse Jacobians: a dense (n, cols) block that is reused across calls (per thread)
+static arr& jacobian_block(uint n, uint cols) {
+  static thread_local arr B;
+  B.resize(n, cols).setZero();
+  return B;
+}
+
+/// J becomes the sparse (B.d0, N)-matrix with the dense block B in the given columns; reuses J's memory
+static void setSparseJacobian(arr& J, const arr& B, uint N, const uintA& cols) {
+  SparseMatrix& S = J.sparse();
+  S.resize(B.d0, N, B.N);
+  memmove(J.p, B.p, B.N*B.sizeT); //row-major, as the elems below
+  int* e = S.elems.p;
+  for(uint i=0; i<B.d0; i++) for(uint c:cols) { *(e++) = i; *(e++) = c; }
+}
+
+//-- fixed-size helpers for the jacobian blocks (no heap allocation per joint)
+
+/// the first two columns of the rotation matrix, scaled
+static FixedArr<3,2> scaledRotationXY(const Quaternion& rot, double scale) {
+  FixedArr<3,3> R;
+  rot.getMatrix(R.p);
+  return { scale*R(0,0), scale*R(0,1), scale*R(1,0), scale*R(1,1), scale*R(2,0), scale*R(2,1) };
+}
+
+/// column c of R, times sign
+static FixedArr<3> column(const FixedArr<3,3>& R, uint c, double sign) {
+  return { sign*R(0,c), sign*R(1,c), sign*R(2,c) };
+}
+
+/// the jacobian of the rotation rel w.r.t. its quaternion, expressed in world coordinates via X
+static FixedArr<3,4> quatJacobianWorld(const Quaternion& X, const Quaternion& rel) {
+  FixedArr<3,3> R;
+  FixedArr<3,4> Jq;
+  X.getMatrix(R.p);
+  rel.getJacobian(Jq.p);
+  return R*Jq;
+}
+
 /// what is the linear velocity of a world point (pos_world) attached to frame a for a given joint velocity?
 void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) const {
   CHECK_EQ(&a->C, this, "");
@@ -1622,110 +2236,112 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
 
   a->ensure_X();
 
-  uint N=getJointStateDimension();
-  jacobian_zero(J, 3);
   if(!J) return;
+  uint N=getJointStateDimension();
 
-  while(a) { //loop backward down the kinematic tree
-    if(!a->parent) break; //frame has no inlink -> done
-    Joint* j=a->joint;
-    if(j && j->active) {
-      uint j_idx=j->qIndex;
-      CHECK_LE(j_idx, q.N, "");
-      if(j_idx>=N) if(j->active) CHECK_EQ(j->type, JT_rigid, "");
-      if(j_idx<N) {
-        if(j->type==JT_hingeX || j->type==JT_hingeY || j->type==JT_hingeZ) {
-          Vector tmp = j->axis ^ (pos_world-j->X()*j->Q().pos);
-          tmp *= j->scale;
-          J.elem(0, j_idx) += tmp.x;
-          J.elem(1, j_idx) += tmp.y;
-          J.elem(2, j_idx) += tmp.z;
-        } else if(j->type==JT_transX || j->type==JT_transY || j->type==JT_transZ || j->type==JT_XBall) {
-          J.elem(0, j_idx) += j->scale * j->axis.x;
-          J.elem(1, j_idx) += j->scale * j->axis.y;
-          J.elem(2, j_idx) += j->scale * j->axis.z;
-        } else if(j->type==JT_transXY) {
-          arr R = j->X().rot.getArr();
-          R *= j->scale;
-          J.setMatrixBlock(R.sub(0, -1, 0, 1), 0, j_idx);
-        } else if(j->type==JT_transXYPhi) {
-          arr R = j->X().rot.getArr();
-          R *= j->scale;
-          J.setMatrixBlock(R.sub(0, -1, 0, 1), 0, j_idx);
-          Vector tmp = j->axis ^ (pos_world-(j->X().pos + j->X().rot*a->Q.pos));
-          tmp *= j->scale;
-          J.elem(0, j_idx+2) += tmp.x;
-          J.elem(1, j_idx+2) += tmp.y;
-          J.elem(2, j_idx+2) += tmp.z;
-        } else if(j->type==JT_phiTransXY) {
-          Vector tmp = j->axis ^ (pos_world-j->X().pos);
-          tmp *= j->scale;
-          J.elem(0, j_idx) += tmp.x;
-          J.elem(1, j_idx) += tmp.y;
-          J.elem(2, j_idx) += tmp.z;
-          arr R = (j->X().rot*a->Q.rot).getArr();
-          R *= j->scale;
-          J.setMatrixBlock(R.sub(0, -1, 0, 1), 0, j_idx+1);
-        }
-        if(j->type==JT_generic){
-          arr R = j->frame->parent->get_X().rot.getArr();
-          R *= j->scale;
-          arr Rt =~R;
-          Vector d = (pos_world-j->X()*j->Q().pos);
-          arr D = skew(d.getArr());
-
-          for(uint i=0;i<j->code.N;i++){
-            switch(j->code[i]){
-              case 't': break;
-              case 'x':  J.setMatrixBlock(Rt[0], 0, j_idx+i);  break;
-              case 'X':  J.setMatrixBlock(-Rt[0], 0, j_idx+i);  break;
-              case 'y':  J.setMatrixBlock(Rt[1], 0, j_idx+i);  break;
-              case 'Y':  J.setMatrixBlock(-Rt[1], 0, j_idx+i);  break;
-              case 'z':  J.setMatrixBlock(Rt[2], 0, j_idx+i);  break;
-              case 'Z':  J.setMatrixBlock(-Rt[2], 0, j_idx+i);  break;
-              case 'a':  J.setMatrixBlock(-D*Rt[0], 0, j_idx+i);  break;
-              case 'A':  J.setMatrixBlock(D*Rt[0], 0, j_idx+i);  break;
-              case 'b':  J.setMatrixBlock(-D*Rt[1], 0, j_idx+i);  break;
-              case 'B':  J.setMatrixBlock(D*Rt[1], 0, j_idx+i);  break;
-              case 'c':  J.setMatrixBlock(-D*Rt[2], 0, j_idx+i);  break;
-              case 'C':  J.setMatrixBlock(D*Rt[2], 0, j_idx+i);  break;
-              case 'w':{
-                arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
-                Jrot *= j->scale;
-                Jrot = crossProduct(Jrot, conv_vec2arr(d));  //cross-product of all 4 w-vectors with lever
-                Jrot /= sqrt(sumOfSqr(q({j_idx+i, j_idx+i+3})));   //account for the potential non-normalization of q
-                J.setMatrixBlock(Jrot, 0, j_idx+i);
-                i+=3;
-              } break;
-            }
+  //sparse: fill a dense block over the chain's columns only, then set the sparse J in one go
+  bool sparse = (jacMode==JM_sparse);
+  const uintA* cols = sparse ? &jacobian_chainColumns(a) : nullptr;
+  arr& Jw = sparse ? jacobian_block(3, cols->N) : J;
+  if(!sparse) { jacobian_zero(J, 3); if(!J) return; }
+
+  for(const ChainLink& l:jacobian_chain(a)) { //loop backward down the kinematic tree, over the active joints only
+    Joint* j=l.joint;
+    Frame* f=j->frame;
+    uint j_idx=l.qIndex;
+    uint c = sparse ? l.local : j_idx; //column to write to
+    switch(l.type) {
+      case JT_hingeX: case JT_hingeY: case JT_hingeZ: {
+        Vector tmp = j->axis ^ (pos_world-j->X()*j->Q().pos);
+        tmp *= j->scale;
+        Jw.elem(0, c) += tmp.x;
+        Jw.elem(1, c) += tmp.y;
+        Jw.elem(2, c) += tmp.z;
+      } break;
+      case JT_transX: case JT_transY: case JT_transZ: {
+        Jw.elem(0, c) += j->scale * j->axis.x;
+        Jw.elem(1, c) += j->scale * j->axis.y;
+        Jw.elem(2, c) += j->scale * j->axis.z;
+      } break;
+      case JT_transXY: {
+        setMatrixBlock(Jw, scaledRotationXY(j->X().rot, j->scale), 0, c);
+      } break;
+      case JT_transXYPhi: {
+        setMatrixBlock(Jw, scaledRotationXY(j->X().rot, j->scale), 0, c);
+        Vector tmp = j->axis ^ (pos_world-(j->X().pos + j->X().rot*f->Q.pos));
+        tmp *= j->scale;
+        Jw.elem(0, c+2) += tmp.x;
+        Jw.elem(1, c+2) += tmp.y;
+        Jw.elem(2, c+2) += tmp.z;
+      } break;
+      case JT_phiTransXY: {
+        Vector tmp = j->axis ^ (pos_world-j->X().pos);
+        tmp *= j->scale;
+        Jw.elem(0, c) += tmp.x;
+        Jw.elem(1, c) += tmp.y;
+        Jw.elem(2, c) += tmp.z;
+        setMatrixBlock(Jw, scaledRotationXY(j->X().rot*f->Q.rot, j->scale), 0, c+1);
+      } break;
+      case JT_generic: {
+        FixedArr<3,3> R;
+        j->frame->parent->get_X().rot.getMatrix(R.p);
+        R *= j->scale;
+        Vector d = (pos_world-j->X()*j->Q().pos);
+        FixedArr<3> D(&d.x);
+
+        for(uint i=0;i<j->code.N;i++){
+          switch(j->code[i]){
+            case 't': break;
+            case 'x':  setMatrixBlock(Jw, column(R, 0, +1.), 0, c+i);  break;
+            case 'X':  setMatrixBlock(Jw, column(R, 0, -1.), 0, c+i);  break;
+            case 'y':  setMatrixBlock(Jw, column(R, 1, +1.), 0, c+i);  break;
+            case 'Y':  setMatrixBlock(Jw, column(R, 1, -1.), 0, c+i);  break;
+            case 'z':  setMatrixBlock(Jw, column(R, 2, +1.), 0, c+i);  break;
+            case 'Z':  setMatrixBlock(Jw, column(R, 2, -1.), 0, c+i);  break;
+            case 'a':  setMatrixBlock(Jw, crossProduct(D, column(R, 0, -1.)), 0, c+i);  break;
+            case 'A':  setMatrixBlock(Jw, crossProduct(D, column(R, 0, +1.)), 0, c+i);  break;
+            case 'b':  setMatrixBlock(Jw, crossProduct(D, column(R, 1, -1.)), 0, c+i);  break;
+            case 'B':  setMatrixBlock(Jw, crossProduct(D, column(R, 1, +1.)), 0, c+i);  break;
+            case 'c':  setMatrixBlock(Jw, crossProduct(D, column(R, 2, -1.)), 0, c+i);  break;
+            case 'C':  setMatrixBlock(Jw, crossProduct(D, column(R, 2, +1.)), 0, c+i);  break;
+            case 'w':{
+              FixedArr<3,4> Jrot = quatJacobianWorld(j->X().rot, f->Q.rot); //transform w-vectors into world coordinate
+              Jrot *= j->scale;
+              Jrot = crossProduct(Jrot, D);  //cross-product of all 4 w-vectors with lever
+              Jrot /= sqrt(sumOfSqr(q({j_idx+i, j_idx+i+3})));   //account for the potential non-normalization of q
+              setMatrixBlock(Jw, Jrot, 0, c+i);
+              i+=3;
+            } break;
           }
         }
-        if(j->type==JT_XBall) {
-          arr R = conv_vec2arr(j->X().rot.getX());
+      } break;
+      case JT_XBall: case JT_trans3: case JT_free: case JT_quatBall: {
+        if(l.type==JT_XBall) {
+          Vector x = j->X().rot.getX();
+          FixedArr<3> R(&x.x);
           R *= j->scale;
-          R.reshape(3, 1);
-          J.setMatrixBlock(R, 0, j_idx);
+          setMatrixBlock(Jw, R, 0, c);
         }
-        if(j->type==JT_trans3 || j->type==JT_free) {
-          arr R = j->X().rot.getArr();
+        if(l.type==JT_trans3 || l.type==JT_free) {
+          FixedArr<3,3> R;
+          j->X().rot.getMatrix(R.p);
           R *= j->scale;
-          J.setMatrixBlock(R, 0, j_idx);
+          setMatrixBlock(Jw, R, 0, c);
         }
-        if(j->type==JT_quatBall || j->type==JT_free || j->type==JT_XBall) {
-          uint offset = 0;
-          if(j->type==JT_XBall) offset=1;
-          if(j->type==JT_free) offset=3;
-          arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
-          Jrot = crossProduct(Jrot, conv_vec2arr(pos_world-(j->X().pos+j->X().rot*a->Q.pos)));  //cross-product of all 4 w-vectors with lever
-          Jrot /= sqrt(sumOfSqr(q({j->qIndex+offset, j->qIndex+offset+3})));   //account for the potential non-normalization of q
-          //          for(uint i=0;i<4;i++) for(uint k=0;k<3;k++) J.elem(k,j_idx+offset+i) += Jrot(k,i);
+        if(l.type!=JT_trans3) {
+          uint offset = l.type==JT_XBall ? 1 : l.type==JT_free ? 3 : 0;
+          FixedArr<3,4> Jrot = quatJacobianWorld(j->X().rot, f->Q.rot); //transform w-vectors into world coordinate
+          Vector lever = pos_world-(j->X().pos+j->X().rot*f->Q.pos);
+          Jrot = crossProduct(Jrot, FixedArr<3>(&lever.x));  //cross-product of all 4 w-vectors with lever
+          Jrot /= sqrt(sumOfSqr(q({j_idx+offset, j_idx+offset+3})));   //account for the potential non-normalization of q
           Jrot *= j->scale;
-          J.setMatrixBlock(Jrot, 0, j_idx+offset);
+          setMatrixBlock(Jw, Jrot, 0, c+offset);
         }
-      }
+      } break;
+      default: break;
     }
-    a = a->parent;
   }
+  if(sparse) setSparseJacobian(J, Jw, N, *cols);
 
 //  if(isSparseMatrix(J) && xIndex) {
 //    J.sparse().reshape(J.d0, J.d1+xIndex);
@@ -1737,62 +2353,63 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
 void Configuration::jacobian_angular(arr& J, Frame* a) const {
   a->ensure_X();
 
-  uint N = getJointStateDimension();
-  jacobian_zero(J, 3);
   if(!J) return;
+  uint N = getJointStateDimension();
 
-  while(a) { //loop backward down the kinematic tree
-    Joint* j=a->joint;
-    if(j && j->active) {
-      uint j_idx=j->qIndex;
-      if(j_idx>=N) CHECK_EQ(j->type, JT_rigid, "");
-      if(j_idx<N) {
-        if((j->type>=JT_hingeX && j->type<=JT_hingeZ) || j->type==JT_transXYPhi || j->type==JT_phiTransXY) {
-          if(j->type==JT_transXYPhi) j_idx += 2; //refer to the phi only
-          J.elem(0, j_idx) += j->scale * j->axis.x;
-          J.elem(1, j_idx) += j->scale * j->axis.y;
-          J.elem(2, j_idx) += j->scale * j->axis.z;
-        }
-        if(j->type==JT_quatBall || j->type==JT_free || j->type==JT_XBall) {
-          uint offset = 0;
-          if(j->type==JT_XBall) offset=1;
-          if(j->type==JT_free) offset=3;
-          arr Jrot = j->X().rot.getArr() * a->get_Q().rot.getJacobian(); //transform w-vectors into world coordinate
-          Jrot /= sqrt(sumOfSqr(q({j->qIndex+offset, j->qIndex+offset+3}))); //account for the potential non-normalization of q
-          //          for(uint i=0;i<4;i++) for(uint k=0;k<3;k++) J.elem(k,j_idx+offset+i) += Jrot(k,i);
-          Jrot *= j->scale;
-          J.setMatrixBlock(Jrot, 0, j_idx+offset);
-        }
-        if(j->type==JT_generic) {
-          arr R = j->frame->parent->get_X().rot.getArr();
-          R *= j->scale;
-          arr Rt =~R;
-
-          for(uint i=0;i<j->code.N;i++){
-            switch(j->code[i]){
-              case 't': break;
-              case 'a':  J.setMatrixBlock(Rt[0], 0, j_idx+i);  break;
-              case 'A':  J.setMatrixBlock(-Rt[0], 0, j_idx+i);  break;
-              case 'b':  J.setMatrixBlock(Rt[1], 0, j_idx+i);  break;
-              case 'B':  J.setMatrixBlock(-Rt[1], 0, j_idx+i);  break;
-              case 'c':  J.setMatrixBlock(Rt[2], 0, j_idx+i);  break;
-              case 'C':  J.setMatrixBlock(-Rt[2], 0, j_idx+i);  break;
-              case 'w':{
-                arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
-                Jrot *= j->scale;
-                Jrot /= sqrt(sumOfSqr(q({j_idx+i, j_idx+i+3}))); //account for the potential non-normalization of q
-                J.setMatrixBlock(Jrot, 0, j_idx+i);
-                i+=3;
-              } break;
-            }
+  //sparse: as in jacobian_pos
+  bool sparse = (jacMode==JM_sparse);
+  const uintA* cols = sparse ? &jacobian_chainColumns(a) : nullptr;
+  arr& Jw = sparse ? jacobian_block(3, cols->N) : J;
+  if(!sparse) { jacobian_zero(J, 3); if(!J) return; }
+
+  for(const ChainLink& l:jacobian_chain(a)) { //loop backward down the kinematic tree, over the active joints only
+    Joint* j=l.joint;
+    Frame* f=j->frame;
+    uint j_idx=l.qIndex;
+    uint c = sparse ? l.local : j_idx; //column to write to
+    switch(l.type) {
+      case JT_transXYPhi: c += 2; //refer to the phi only
+      /* fall through */
+      case JT_hingeX: case JT_hingeY: case JT_hingeZ: case JT_phiTransXY: {
+        Jw.elem(0, c) += j->scale * j->axis.x;
+        Jw.elem(1, c) += j->scale * j->axis.y;
+        Jw.elem(2, c) += j->scale * j->axis.z;
+      } break;
+      case JT_quatBall: case JT_free: case JT_XBall: {
+        uint offset = l.type==JT_XBall ? 1 : l.type==JT_free ? 3 : 0;
+        FixedArr<3,4> Jrot = quatJacobianWorld(j->X().rot, f->get_Q().rot); //transform w-vectors into world coordinate
+        Jrot /= sqrt(sumOfSqr(q({j_idx+offset, j_idx+offset+3}))); //account for the potential non-normalization of q
+        Jrot *= j->scale;
+        setMatrixBlock(Jw, Jrot, 0, c+offset);
+      } break;
+      case JT_generic: {
+        FixedArr<3,3> R;
+        j->frame->parent->get_X().rot.getMatrix(R.p);
+        R *= j->scale;
+
+        for(uint i=0;i<j->code.N;i++){
+          switch(j->code[i]){
+            case 't': break;
+            case 'a':  setMatrixBlock(Jw, column(R, 0, +1.), 0, c+i);  break;
+            case 'A':  setMatrixBlock(Jw, column(R, 0, -1.), 0, c+i);  break;
+            case 'b':  setMatrixBlock(Jw, column(R, 1, +1.), 0, c+i);  break;
+            case 'B':  setMatrixBlock(Jw, column(R, 1, -1.), 0, c+i);  break;
+            case 'c':  setMatrixBlock(Jw, column(R, 2, +1.), 0, c+i);  break;
+            case 'C':  setMatrixBlock(Jw, column(R, 2, -1.), 0, c+i);  break;
+            case 'w':{
+              FixedArr<3,4> Jrot = quatJacobianWorld(j->X().rot, f->Q.rot); //transform w-vectors into world coordinate
+              Jrot *= j->scale;
+              Jrot /= sqrt(sumOfSqr(q({j_idx+i, j_idx+i+3}))); //account for the potential non-normalization of q
+              setMatrixBlock(Jw, Jrot, 0, c+i);
+              i+=3;
+            } break;
           }
-
         }
-        //all other joints: J=0 !!
-      }
+      } break;
+      default: break; //all other joints: J=0 !!
     }
-    a = a->parent;
   }
+  if(sparse) setSparseJacobian(J, Jw, N, *cols);
 }
 
 /// how does the time coordinate of frame a change with q-change?
@@ -1879,7 +2496,8 @@ void Configuration::kinematicsQuat(arr& y, arr& J, Frame* a) const { //TODO: all
 
   const Quaternion& rot_a = a->ensure_X().rot;
   if(!!y) y = rot_a.getArr4d();
-  arr ROT_A = rot_a.getQuaternionMultiplicationMatrix();
+  FixedArr<4,4> ROT_A;
+  rot_a.getQuaternionMultiplicationMatrix(ROT_A.p);
 
   arr A;
   jacobian_angular(A, a);
@@ -1892,17 +2510,19 @@ void Configuration::kinematicsQuat(arr& y, arr& J, Frame* a) const { //TODO: all
     J.sparse().reshape(4, A.d1);
     J.sparse().colShift(1);
     J *= .5;
-    J = ROT_A * J;
+    J = ROT_A.view() * J;
   } else if(isRowShifted(A)) {
     J = A;
     J *= .5;
     J.rowShifted().insRow(0);
-    J = ROT_A * J;
+    J = ROT_A.view() * J;
   } else if(!isSpecial(A)) {
-    J.resize(4, A.d1).setZero();
-    J.setMatrixBlock(A, 1, 0);
-    J *= .5;
-    J = ROT_A * J;
+    //J = ROT_A * [0; .5*A], column by column, skipping the zero first row
+    J.resize(4, A.d1);
+    for(uint k=0; k<A.d1; k++) {
+      FixedArr<3> Ak = { .5*A.p[k], .5*A.p[A.d1+k], .5*A.p[2*A.d1+k] };
+      for(uint i=0; i<4; i++) J.p[i*A.d1+k] = ROT_A(i,1)*Ak(0) + ROT_A(i,2)*Ak(1) + ROT_A(i,3)*Ak(2);
+    }
   } else NIY;
 }
 
@@ -2021,6 +2641,126 @@ void Configuration::hessianPos(arr& H, Frame* a, Vector* rel) const {
   }
 }
 
+//-- exact second-order kinematics over the active chain (hinges and 1D prismatic joints only)
+
+/// world axes, origins, types and scales of the chain's joints -- false if the chain has other joint types
+static bool hessian_chainGeometry(const ChainLinkA& chain, Array<Vector>& w, Array<Vector>& o, boolA& hinge, arr& s) {
+  uint K=chain.N;
+  w.resize(K);  o.resize(K);  hinge.resize(K);  s.resize(K);
+  for(uint k=0; k<K; k++) {
+    const ChainLink& l=chain.elem(k);
+    Joint* j=l.joint;
+    if(l.type>=JT_hingeX && l.type<=JT_hingeZ) hinge.elem(k)=true;
+    else if(l.type>=JT_transX && l.type<=JT_transZ) hinge.elem(k)=false;
+    else return false;
+    w.elem(k) = j->axis;
+    o.elem(k) = j->X()*j->Q().pos;
+    s.elem(k) = j->scale;
+  }
+  return true;
+}
+
+/// the (Hamilton) product ab=a*b of two, not necessarily normalized, quaternions as 4-vectors (w,x,y,z)
+static void quatProduct(double* ab, const double* a, const double* b) {
+  ab[0] = a[0]*b[0] - a[1]*b[1] - a[2]*b[2] - a[3]*b[3];
+  ab[1] = a[0]*b[1] + a[1]*b[0] + a[2]*b[3] - a[3]*b[2];
+  ab[2] = a[0]*b[2] - a[1]*b[3] + a[2]*b[0] + a[3]*b[1];
+  ab[3] = a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + a[3]*b[0];
+}
+
+/** @brief the weighted Hessian \f$H = \sum_i c_i \frac{\partial^2 y_i}{\partial q\partial q}\f$ of the world position y
+    of a point (pos_world) attached to frame a, as a (K,K)-block over jacobian_chainColumns(a) (columns may repeat
+    for mimic joints -- entries then add up). Returns false (and leaves H untouched) if the chain contains joints
+    other than hinges and 1D prismatic joints. In the loops below, l>k means joint l is rootward of joint k. */
+bool Configuration::hessian_pos(arr& H, Frame* a, const Vector& pos_world, const arr& c) const {
+  CHECK_EQ(&a->C, this, "");
+  CHECK_EQ(c.N, 3, "");
+  a->ensure_X();
+  const ChainLinkA& chain = jacobian_chain(a);
+  Array<Vector> w, o;
+  boolA hinge;
+  arr s;
+  if(!hessian_chainGeometry(chain, w, o, hinge, s)) return false;
+
+  Vector cw(c.elem(0), c.elem(1), c.elem(2));
+  uint K=chain.N;
+  H.resize(K, K).setZero();
+  for(uint k=0; k<K; k++) for(uint l=k; l<K; l++) {
+    Vector d; //the derivative of column k of the Jacobian w.r.t. joint l
+    if(hinge(k) && hinge(l)) {
+      Vector r = pos_world - o(k);
+      d = w(k) ^ (w(l) ^ r);
+      if(l>k) d += (w(l) ^ w(k)) ^ r; //the rootward hinge also turns the axis of k
+    } else if(!hinge(k) && hinge(l) && l>k) {
+      d = w(l) ^ w(k);
+    } else continue;
+    H(k, l) = H(l, k) = s(k)*s(l)*(cw*d);
+  }
+  return true;
+}
+
+/// as hessian_pos, for a world vector (vec_world) attached to frame a
+bool Configuration::hessian_vec(arr& H, Frame* a, const Vector& vec_world, const arr& c) const {
+  CHECK_EQ(&a->C, this, "");
+  CHECK_EQ(c.N, 3, "");
+  a->ensure_X();
+  const ChainLinkA& chain = jacobian_chain(a);
+  Array<Vector> w, o;
+  boolA hinge;
+  arr s;
+  if(!hessian_chainGeometry(chain, w, o, hinge, s)) return false;
+
+  Vector cw(c.elem(0), c.elem(1), c.elem(2));
+  uint K=chain.N;
+  H.resize(K, K).setZero();
+  for(uint k=0; k<K; k++) for(uint l=k; l<K; l++) {
+    if(!hinge(k) || !hinge(l)) continue; //prismatic joints don't turn vectors
+    Vector d = w(k) ^ (w(l) ^ vec_world);
+    if(l>k) d += (w(l) ^ w(k)) ^ vec_world;
+    H(k, l) = H(l, k) = s(k)*s(l)*(cw*d);
+  }
+  return true;
+}
+
+/// as hessian_pos, for the world quaternion of frame a (whose Jacobian columns are [0, w_k/2] * q)
+bool Configuration::hessian_quat(arr& H, Frame* a, const arr& c) const {
+  CHECK_EQ(&a->C, this, "");
+  CHECK_EQ(c.N, 4, "");
+  const Quaternion& rot_a = a->ensure_X().rot;
+  const ChainLinkA& chain = jacobian_chain(a);
+  Array<Vector> w, o;
+  boolA hinge;
+  arr s;
+  if(!hessian_chainGeometry(chain, w, o, hinge, s)) return false;
+
+  uint K=chain.N;
+  double qa[4] = {rot_a.w, rot_a.x, rot_a.y, rot_a.z};
+  arr W(K, 4), Jq(K, 4); //the half axes as pure quaternions, and the (unscaled) Jacobian columns
+  W.setZero();
+  Jq.setZero();
+  for(uint k=0; k<K; k++) if(hinge(k)) {
+    W(k, 1) = .5*w(k).x;  W(k, 2) = .5*w(k).y;  W(k, 3) = .5*w(k).z;
+    quatProduct(&Jq(k, 0), &W(k, 0), qa);
+  }
+
+  H.resize(K, K).setZero();
+  double d[4], e[4];
+  for(uint k=0; k<K; k++) for(uint l=k; l<K; l++) {
+    if(!hinge(k) || !hinge(l)) continue;
+    quatProduct(d, &W(k, 0), &Jq(l, 0));
+    if(l>k) { //the rootward hinge also turns the axis of k
+      Vector wlk = w(l) ^ w(k);
+      double h[4] = {0., .5*wlk.x, .5*wlk.y, .5*wlk.z};
+      quatProduct(e, h, qa);
+      for(uint i=0; i<4; i++) d[i] += e[i];
+    }
+    double cd = 0.;
+    for(uint i=0; i<4; i++) cd += c.elem(i)*d[i];
+    H(k, l) = H(l, k) = s(k)*s(l)*cd;
+  }
+  return true;
+}
+
 void Configuration::equationOfMotion(arr& M, arr& F, const arr& qdot, bool gravity) {
   fs().update();
   fs().setGravity();
@@ -2207,6 +2947,7 @@ void Configuration::addProxies(const uintA& collisionPairs) {
 }
 
 void Configuration::stepSwift() {
+  RAI_PROFILE("Configuration::stepSwift");
   arr X = getFrameState();
   uintA collisionPairs = swift()->step(X, false);
   //  reportProxies();
@@ -2219,6 +2960,7 @@ void Configuration::stepSwift() {
 }
 
 void Configuration::stepFcl() {
+  RAI_PROFILE("Configuration::stepFcl");
   //-- get the frame state of collision objects
   arr X = getFrameState();
   //-- step fcl
@@ -2343,7 +3085,7 @@ void Configuration::copyProxies(const ProxyA& _proxies) {
 
 /// prototype for \c operator<<
 void Configuration::write(std::ostream& os, bool explicitlySorted) const {
-  for(Frame* f: frames) if(!f->name.N) f->name <<'_' <<f->ID;
+  for(Frame* f: frames) if(!f->name.N) f->setName(STRING('_' <<f->ID));
   if(!explicitlySorted){
     for(Frame* f: frames) f->write(os);
   }else{
@@ -2354,7 +3096,7 @@ void Configuration::write(std::ostream& os, bool explicitlySorted) const {
 }
 
 void Configuration::write(Graph& G) const {
-  for(Frame* f: frames) if(!f->name.N) f->name <<'_' <<f->ID;
+  for(Frame* f: frames) if(!f->name.N) f->setName(STRING('_' <<f->ID));
   for(Frame* f: frames) f->write(G.newSubgraph({f->name}));
 }
 
@@ -2558,16 +3300,16 @@ Graph Configuration::getGraph() const {
     Node* n = G.elem(f->ID);
     if(f->parent) {
       n->addParent(G.elem(f->parent->ID));
-      n->key = STRING("Q= " <<f->get_Q());
+      n->setKey(STRING("Q= " <<f->get_Q()));
     }
     if(f->joint) {
-      n->key = (STRING("joint " <<f->joint->type));
+      n->setKey(STRING("joint " <<f->joint->type));
     }
     if(f->shape) {
-      n->key = (STRING("shape " <<f->shape->type()));
+      n->setKey(STRING("shape " <<f->shape->type()));
     }
     if(f->inertia) {
-      n->key = (STRING("inertia m=" <<f->inertia->mass));
+      n->setKey(STRING("inertia m=" <<f->inertia->mass));
     }
   }
 #else
@@ -2663,7 +3405,7 @@ void Configuration::readFromGraph(const Graph& G, bool addInsteadOfClear) {
 
     Frame* b=new Frame(*this);
     node2frame(n->index) = b;
-    b->name=n->key;
+    b->setName(n->key);
     b->ats = make_shared<Graph>();
     b->ats->copy(n->graph(), false, true);
     b->read(*b->ats);
@@ -2687,7 +3429,7 @@ void Configuration::readFromGraph(const Graph& G, bool addInsteadOfClear) {
         b = new Frame(p); //getFrameByName(n->parents(0)->key));
       }else HALT("a frame can only have one parent");
       node2frame(n->index) = b;
-      b->name=n->key;
+      b->setName(n->key);
       b->ats = make_shared<Graph>();
       b->ats->copy(n->graph(), false, true);
       b->read(*b->ats);
@@ -2704,8 +3446,7 @@ void Configuration::readFromGraph(const Graph& G, bool addInsteadOfClear) {
       Frame* pre = from;
       if(n->graph().findNode("A")) {
         pre = new Frame(from);
-        pre->name = n->key;
-        pre->name <<"_pre";
+        pre->setName(STRING(n->key <<"_pre"));
         pre->set_Q()->read(n->graph().get<String>("A"));
         n->graph().delNode(n->graph().findNode("A"));
         n->graph().index();
@@ -2714,7 +3455,7 @@ void Configuration::readFromGraph(const Graph& G, bool addInsteadOfClear) {
       //generate a new 'between' frame
       Frame* b = new Frame(pre);
       node2frame(n->index) = b;
-      b->name=n->key;
+      b->setName(n->key);
 
       //connect the new frame and optionally impose the post node relative transform
       to->setParent(b, false);
@@ -2738,7 +3479,7 @@ void Configuration::readFromGraph(const Graph& G, bool addInsteadOfClear) {
     CHECK(n->key=="shape" || n->graph().findNode("%shape"), "");
 
     Frame* f = new Frame(*this);
-    f->name=n->key;
+    f->setName(n->key);
     f->ats = make_shared<Graph>();
     f->ats->copy(n->graph(), false, true);
     Shape* s = new Shape(*f);
@@ -2766,9 +3507,9 @@ void Configuration::readFromGraph(const Graph& G, bool addInsteadOfClear) {
 
     Frame* f=new Frame(*this);
     if(n->key.N && n->key!="joint") {
-      f->name=n->key;
+      f->setName(n->key);
     } else {
-      f->name <<'|' <<to->name; //the joint frame is actually the link frame of all child frames
+      f->setName(STRING('|' <<to->name)); //the joint frame is actually the link frame of all child frames
     }
     f->ats = make_shared<Graph>();
     f->ats->copy(n->graph(), false, true);
@@ -2931,6 +3672,53 @@ arr Configuration::evalFeature(FeatureSymbol fs, const StringA& frames) const {
   return feat->eval(feat->getFrames(*this));
 }
 
+/** @brief evaluate a feature for many joint states: row i of the returned (Q.d0, dim)-array
+    is the feature value for the joint state Q[i]; if J is given, it becomes the
+    (Q.d0, dim, Q.d1)-array of dense Jacobians. The rows are processed in parallel chunks
+    (on the process-wide task pool), each on its own copy of this configuration -- this
+    configuration itself is not touched. */
+arr Configuration::batchEval(FeatureSymbol fs, const StringA& frames, const arr& Q, arr& J) const {
+  CHECK_EQ(Q.nd, 2, "Q needs to be a (N, jointStateDimension)-array");
+  if(!Q.d0) return arr();
+
+  //-- one copy of the configuration per chunk
+  uint nChunks = rai::taskPool().numThreads()+1;
+  if(nChunks>Q.d0) nChunks=Q.d0;
+  rai::Array<std::shared_ptr<Configuration>> copies(nChunks);
+  for(auto& C:copies) {
+    C = make_shared<Configuration>();
+    C->copy(*this);
+    C->jacMode = JM_dense;
+    CHECK_EQ(Q.d1, C->getJointStateDimension(), "Q has wrong joint state dimension");
+  }
+
+  arrA ys(Q.d0);
+  rai::parallel_for(nChunks, [&](uint c) {
+    Configuration& C = *copies(c);
+    shared_ptr<Feature> feat = C.feature(fs, frames);
+    FrameL F = feat->getFrames(C);
+    arr q(Q.d1); //a per-chunk copy: views into the shared Q are not taken inside the parallel region
+    for(uint i=c*Q.d0/nChunks; i<(c+1)*Q.d0/nChunks; i++) {
+      memmove(q.p, Q.p+i*Q.d1, Q.d1*Q.sizeT);
+      C.setJointState(q);
+      ys(i) = feat->eval(F);
+    }
+  }, 1);
+
+  uint d = ys(0).N;
+  arr y(Q.d0, d);
+  if(!!J) J.resize(Q.d0, d, Q.d1);
+  for(uint i=0; i<Q.d0; i++) {
+    CHECK_EQ(ys(i).N, d, "feature dimension changed across joint states");
+    y[i] = ys(i);
+    if(!!J) {
+      CHECK(ys(i).jac, "feature has no Jacobian");
+      J[i] = ys(i).J().reshape(d, Q.d1);
+    }
+  }
+  return y;
+}
+
 arr Configuration::eval(FeatureSymbol fs, const StringA& frames){
   return feature(fs,frames)->eval(getFrames(frames));
 }
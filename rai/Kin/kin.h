@@ -33,6 +33,7 @@ struct ForceExchange;
 struct ForceExchange;
 struct Configuration;
 struct KinematicSwitch;
+struct ChainLink;
 
 struct FclInterface;
 struct ConfigurationViewer;
@@ -49,6 +50,7 @@ typedef rai::Array<rai::Joint*> JointL;
 typedef rai::Array<rai::Frame*> FrameL;
 typedef rai::Array<rai::Proxy*> ProxyL;
 typedef rai::Array<rai::Proxy> ProxyA;
+typedef rai::Array<rai::ChainLink> ChainLinkA;
 typedef rai::Array<rai::ForceExchange*> ForceExchangeL;
 typedef rai::Array<rai::KinematicSwitch*> KinematicSwitchL;
 typedef rai::Array<rai::Configuration*> ConfigurationL;
@@ -73,6 +75,16 @@ struct Configuration : GLDrawer {
   bool _state_indexedJoints_areGood=false; // the active sets, incl. their topological sorting, are up to date
   bool _state_q_isGood=false; // the q-vector represents the current relative transforms (and force dofs)
   bool _state_proxies_isGood=false; // the proxies have been created for the current state
+  std::unordered_map<std::string, FrameL> frameIndex; // name -> frames with this name, sorted by ID (maintained by Frame constructor/destructor and Frame::setName -- the only way to change a name)
+  bool _state_frameIndex_isGood=true; // the frameIndex is consistent with frames (false after reordering frames)
+  FrameL _flatOrder; // all frames sorted by depth in the tree (computed with calc_flatOrder(); cleared by reset_q() and when frames are (re)linked)
+  intA _flatParent; // for each entry of _flatOrder: the position of its parent in _flatOrder (-1 for roots)
+  uintA _flatLevels; // _flatOrder({_flatLevels(d), _flatLevels(d+1)-1}) are all frames of depth d
+  arr _flatQs, _flatXs; // (7,frames.N) struct-of-arrays of the poses Q and X in _flatOrder: row k holds component k [pos, quat] of all frames
+  arr _flatX; // (frames.N,7)-mirror of all frame poses X, indexed by frame ID (computed with ensure_flatX())
+  bool _state_flatX_isGood=false; // _flatX mirrors the current X of all frames (reset whenever a frame's X becomes bad)
+  uint _chainRevision=1; // incremented whenever joint indexing or links change: invalidates the frames' cached chains
+  void _state_updateAfterRelinking() { _flatOrder.clear(); _state_flatX_isGood=false; _chainRevision++; }
   //TODO: need a _state for all the plugin engines (SWIFT, PhysX)? To auto-reinitialize them when the config changed structurally?
 
   //-- format in which Jacobians are returned
@@ -90,12 +102,14 @@ struct Configuration : GLDrawer {
   /// @name copy
   void operator=(const Configuration& K) { copy(K); } ///< same as copy()
   void copy(const Configuration& K, bool referenceSwiftOnCopy=false);
+  bool hasSameStructure(const Configuration& K) const; ///< same frames, names, tree, and attachment types -- copy then recopies in place into the existing frames
   bool operator!() const;
 
   /// @name initializations, building configurations
   Frame* addFrame(const char* name, const char* parent=nullptr, const char* args=nullptr);
   Frame* addFile(const char* filename);
   Frame* addAssimp(const char* filename);
+  Frame* addFileCached(const char* filename, const char* cacheFile=nullptr); ///< same as addFile(), but loads a binary cache (default: filename.cache), which is recompiled if missing or if any source file changed
   Frame* addCopies(const FrameL& F, const DofL& _dofs);
   void addConfiguration(const Configuration& C, double tau=1.);
 
@@ -103,6 +117,7 @@ struct Configuration : GLDrawer {
   Frame* operator[](const char* name) const { return getFrame(name, true); }  ///< same as getFrame()
   Frame* operator()(int i) const { return frames(i); } ///< same as 'frames.elem(i)'  (the i-th frame)
   Frame* getFrame(const char* name, bool warnIfNotExist=true, bool reverse=false) const;
+  Frame* getFrameInSlice(const char* name, uint s, bool warnIfNotExist=true) const; ///< for time-sliced configurations (frames.nd==2): the frame of this name in slice s
   FrameL getFrames(const uintA& ids) const;
   FrameL getFrames(const StringA& names) const;
   uintA getFrameIDs(const StringA& names) const;
@@ -126,7 +141,7 @@ struct Configuration : GLDrawer {
   arr getJointState(const FrameL& F) const { return getDofState(getDofs(F, false)); }
   arr getJointState(const uintA& F) const { return getJointState(getFrames(F)); } ///< same as getJointState() with getFrames()
   arr getJointStateSlice(uint t, bool activesOnly=true){  return getJointState(getJointsSlice(t, activesOnly));  }
-  arr getFrameState() const { return getFrameState(frames); } ///< same as getFrameState() for all \ref frames
+  arr getFrameState() const; ///< same as getFrameState() for all \ref frames, but a plain copy of ensure_flatX()
   arr getFrameState(const FrameL& F) const;
   arr getFrameState(const uintA& F) const { return getFrameState(getFrames(F)); } ///< same as getFrameState() with getFrames()
 
@@ -190,17 +205,24 @@ struct Configuration : GLDrawer {
   void calc_Q_from_q();  ///< from q compute the joint's Q transformations
   void calcDofsFromConfig();  ///< updates q based on the joint's Q transformations
   arr calc_fwdPropagateVelocities(const arr& qdot);    ///< elementary forward kinematics
+  void calc_frameIndex(); ///< sort of private: rebuild the name->frames frameIndex
+  void calc_flatOrder(); ///< sort of private: compile the depth-sorted order and parent positions of all frames for ensure_flatX()
+  Frame* findIndexedFrame(const char* name, int slice=-1, bool reverse=false); ///< sort of private: the first (or last) frame of this name, or the one in the given slice, via the frameIndex
 
   /// @name ensure state consistencies
   void ensure_indexedJoints() {   if(!_state_indexedJoints_areGood) calc_indexedActiveJoints();  }
   void ensure_q() {  if(!_state_q_isGood) calcDofsFromConfig();  }
   void ensure_proxies() {  if(!_state_proxies_isGood) stepSwift();  }
+  void ensure_frameIndex() {  if(!_state_frameIndex_isGood) calc_frameIndex();  }
+  const arr& ensure_flatX(); ///< computes all frame poses in one sweep over contiguous arrays; returns their (frames.N,7)-mirror
 
   /// @name Jacobians and kinematics (low level)
   void jacobian_pos(arr& J, Frame* a, const Vector& pos_world) const; //usually called internally with kinematicsPos
   void jacobian_angular(arr& J, Frame* a) const; //usually called internally with kinematicsVec or Quat
   void jacobian_tau(arr& J, Frame* a) const;
   void jacobian_zero(arr& J, uint n) const;
+  const ChainLinkA& jacobian_chain(Frame* a) const; ///< the active joints from a to the root, with their types and columns
+  const uintA& jacobian_chainColumns(Frame* a) const; ///< the columns (in the joint state) that the Jacobians of a can depend on -- the sparsity pattern
 
   arr kinematics_pos(Frame* a, const Vector& rel=NoVector) const { arr y,J; kinematicsPos(y, J, a, rel); if(!!J) y.J()=J; return y; }
 
@@ -211,6 +233,9 @@ struct Configuration : GLDrawer {
   void kinematicsQuat(arr& y, arr& J, Frame* a) const;
   void kinematicsPos_wrtFrame(arr& y, arr& J, Frame* b, const Vector& rel, Frame* self) const;
   void hessianPos(arr& H, Frame* a, Vector* rel=0) const;
+  bool hessian_pos(arr& H, Frame* a, const Vector& pos_world, const arr& c) const; ///< H = sum_i c_i d^2 pos_i/dqdq over jacobian_chainColumns(a); false if not available for the chain's joints
+  bool hessian_vec(arr& H, Frame* a, const Vector& vec_world, const arr& c) const; ///< as hessian_pos, for a world vector attached to a
+  bool hessian_quat(arr& H, Frame* a, const arr& c) const; ///< as hessian_pos, for the world quaternion of a
   void kinematicsTau(double& tau, arr& J, Frame* a=0) const;
 
   void kinematicsPenetration(arr& y, arr& J, const Proxy& p, double margin=.0, bool addValues=false) const;
@@ -221,6 +246,7 @@ struct Configuration : GLDrawer {
   /// @name features
   shared_ptr<Feature> feature(FeatureSymbol fs, const StringA& frames= {}) const;
   arr evalFeature(FeatureSymbol fs, const StringA& frames= {}) const;
+  arr batchEval(FeatureSymbol fs, const StringA& frames, const arr& Q, arr& J=NoArr) const; ///< evalFeature for each row of Q (joint states), in parallel on copies
   template<class T> arr eval(const StringA& frames= {}){ return T().eval(getFrames(frames)); }
   arr eval(FeatureSymbol fs, const StringA& frames= {});
 
@@ -263,6 +289,10 @@ struct Configuration : GLDrawer {
   void writeCollada(const char* filename, const char* format="collada") const;
   void writeMeshes(const char* pathPrefix="meshes/") const;
   void read(std::istream& is);
+  void writeCache(const char* cacheFile, const StringA& sourceFiles= {}) const; ///< binary dump of all frames, joints, shapes (incl. meshes & sdfs) and inertias; sourceFiles are fingerprinted for checkCache
+  Frame* readCache(const char* cacheFile); ///< adds all frames of a cache file (without checking its sources)
+  static void compileCache(const char* filename, const char* cacheFile);
+  static bool checkCache(const char* cacheFile); ///< true if the cache exists and none of its source files changed
   void glDraw(struct OpenGL&);
   void glDraw_sub(struct OpenGL& gl, const FrameL& F, int drawOpaqueOrTransparanet=0);
   Graph getGraph() const;
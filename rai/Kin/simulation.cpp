@@ -16,6 +16,7 @@
 #include "F_collisions.h"
 #include "../Gui/opengl.h"
 #include "../Algo/SplineCtrlFeed.h"
+#include "../Core/profile.h"
 
 #include <iomanip>
 //#define BACK_BRIDGE
@@ -147,6 +148,7 @@ Simulation::~Simulation() {
 }
 
 void Simulation::step(const arr& u_control, double tau, ControlMode u_mode) {
+  RAI_PROFILE("Simulation::step");
   //-- kill done imps
   for(uint i=imps.N; i--;) {
     if(imps.elem(i)->killMe) imps.remove(i);
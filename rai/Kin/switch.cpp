@@ -161,7 +161,7 @@ rai::Frame* rai::KinematicSwitch::apply(FrameL& frames) const {
 
     if(!jB.isZero()) {
       Frame *newto = new Frame(to->C);
-      newto->name <<'<' <<to->name;
+      newto->setName(STRING('<' <<to->name));
       to->setParent(newto, false);
       to->set_Q() = jB;
       to=newto;
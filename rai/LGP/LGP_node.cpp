@@ -15,6 +15,7 @@
 #include "../Gui/opengl.h"
 #include "../Kin/viewer.h"
 #include "../Optim/NLP_Solver.h"
+#include "../Core/profile.h"
 
 #define DEBUG(x) //x
 #define DEL_INFEASIBLE(x) //x
@@ -129,6 +130,7 @@ void LGP_Node::expand(int verbose) {
 }
 
 void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
+  RAI_PROFILE("LGP_Node::optBound");
   if(tree.filComputes) (*tree.filComputes) <<id <<'-' <<step <<'-' <<bound <<endl;
   ensure_skeleton();
   skeleton->setConfiguration(tree.kin);
@@ -472,11 +474,13 @@ void LGP_Node::getGraph(Graph& G, Node* n, bool brief) {
   }
 
   if(!brief) {
-    n->key <<STRING("\ns:" <<step <<" t:" <<time <<" bound:" <<highestBound <<" feas:" <<!isInfeasible <<" term:" <<isTerminal <<' ' <<folState->isNodeOfGraph->key);
+    String key = n->key;
+    key <<STRING("\ns:" <<step <<" t:" <<time <<" bound:" <<highestBound <<" feas:" <<!isInfeasible <<" term:" <<isTerminal <<' ' <<folState->isNodeOfGraph->key);
     for(uint l=0; l<L; l++) if(count(l))
-      n->key <<STRING('\n' <<Enum<BoundType>::name(l) <<" #:" <<count(l) <<" c:" <<cost(l) <<"|" <<constraints(l) <<" " <<(feasible(l)?'1':'0') <<" time:" <<computeTime(l));
-    if(folAddToState) n->key <<STRING("\nsymAdd:" <<*folAddToState);
-    if(note.N) n->key <<'\n' <<note;
+      key <<STRING('\n' <<Enum<BoundType>::name(l) <<" #:" <<count(l) <<" c:" <<cost(l) <<"|" <<constraints(l) <<" " <<(feasible(l)?'1':'0') <<" time:" <<computeTime(l));
+    if(folAddToState) key <<STRING("\nsymAdd:" <<*folAddToState);
+    if(note.N) key <<'\n' <<note;
+    n->setKey(key);
   }
 
   G.getRenderingInfo(n).dotstyle="shape=box";
@@ -44,6 +44,7 @@ FOL_World::FOL_World()
     state(nullptr), lastDecisionInState(nullptr), verbose(0), verbFil(0),
     lastStepReward(0.), lastStepDuration(0.), lastStepProbability(1.), lastStepObservation(0), count(0) {
   KB.isDoubleLinked=false;
+  KB.indexKeys(); //symbols are looked up by name
 }
 
 FOL_World::FOL_World(const char* filename) : FOL_World() {
@@ -131,10 +132,10 @@ TreeSearchDomain::TransitionReturn FOL_World::transition(const Handle& action) {
     NodeL decisionTuple = {d->rule};
     decisionTuple.append(d->substitution);
     lastDecisionInState = createNewFact(*state, decisionTuple);
-    lastDecisionInState->key = ("decision");
+    lastDecisionInState->setKey("decision");
   } else {
     lastDecisionInState = createNewFact(*state, {Wait_keyword});
-    lastDecisionInState->key = ("decision");
+    lastDecisionInState->setKey("decision");
   }
 
   //-- apply effects of decision
@@ -292,7 +293,7 @@ void FOL_World::make_current_state_new_start() {
   if(!start_state) start_state = &KB.newSubgraph({"START_STATE"}, state->isNodeOfGraph->parents);
   state->index();
   start_state->copy(*state);
-  start_state->isNodeOfGraph->key="START_STATE";
+  start_state->isNodeOfGraph->setKey("START_STATE");
   start_T_step = T_step;
   start_T_real = T_real;
   DEBUG(KB.checkConsistency();)
@@ -61,8 +61,7 @@ void AStar_Node::getGraph(rai::Graph& G, rai::Node* n) {
   } else {
     n = G.newNode<bool>({STRING("a:"<<*action)}, {n}, true);
   }
-  n->key <<STRING("d:" <<d <<" t:" <<time <<' ');
-  n->key <<STRING("f:" <<g+h <<" g:" <<g <<" h:" <<h);
+  n->setKey(STRING(n->key <<"d:" <<d <<" t:" <<time <<' ' <<"f:" <<g+h <<" g:" <<g <<" h:" <<h));
 //  if(mcStats && mcStats->n) n->keys.append(STRING("MC best:" <<mcStats->X.first() <<" n:" <<mcStats->n));
 //  n->keys.append(STRING("sym  #" <<mcCount <<" f:" <<symCost <<" terminal:" <<isTerminal));
 //  n->keys.append(STRING("pose #" <<poseCount <<" f:" <<poseCost <<" g:" <<poseConstraints <<" feasible:" <<poseFeasible));
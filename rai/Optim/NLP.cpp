@@ -96,7 +96,7 @@ double NLP::eval_scalar(arr& g, arr& H, const arr& x){
     }
     H = comp_At_A(tmp); //Gauss-Newton type!
 
-    if(hasF) { //For f-terms, the Hessian must be given explicitly, and is not \propto J^T J
+    if(hasF || sosHessian) { //For f-terms, the Hessian must be given explicitly, and is not \propto J^T J
       arr fH;
       getFHessian(fH, x);
       if(fH.N) H += fH;
@@ -41,6 +41,7 @@ protected:
 public:
   ObjectiveTypeA featureTypes;
   arr bounds_lo, bounds_up;
+  bool sosHessian=false; ///< whether getFHessian also returns curvature terms of sos features (then solvers query it even without f-features)
 
 public:
   virtual ~NLP() {}
@@ -50,6 +51,7 @@ public:
     bounds_lo = P.bounds_lo;
     bounds_up = P.bounds_up;
     featureTypes = P.featureTypes;
+    sosHessian = P.sosHessian;
   };
 
   //-- essential method that needs overload
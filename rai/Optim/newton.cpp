@@ -8,6 +8,7 @@
 
 #include "newton.h"
 #include "optimization.h"
+#include "../Core/profile.h"
 
 #include <iomanip>
 
@@ -60,6 +61,7 @@ void OptNewton::reinit(const arr& _x) {
 //===========================================================================
 
 OptNewton::StopCriterion OptNewton::step() {
+  RAI_PROFILE("OptNewton::step");
   if(!evals) reinit(x);
 
   double fy;
@@ -129,7 +131,8 @@ OptNewton::StopCriterion OptNewton::step() {
     bool inversionFailed=false;
     try {
       if(!rootFinding) {
-        Delta = lapack_Ainv_b_sym(R, -gx);
+        if(isSparseMatrix(R)) Delta = sparseSolver.solve(R, -gx);
+        else Delta = lapack_Ainv_b_sym(R, -gx);
       } else {
         lapack_mldivide(Delta, R, -gx);
       }
@@ -38,4 +38,5 @@ public:
   bool rootFinding=false;
   ostream* logFile=nullptr, *simpleLog=nullptr;
   double timeNewton=0., timeEval=0.;
+  rai::SparseSymSolver sparseSolver; ///< keeps the symbolic analysis of sparse Hessians across steps
 };
@@ -284,7 +284,7 @@ bool Conv_MP_Ipopt::eval_h(Ipopt::Index n, const Ipopt::Number* _x, bool new_x,
   tmp.sparse().rowWiseMult(sqrtCoeff);
   arr H = comp_At_A(tmp); //Gauss-Newton type!
 
-  if(hasFterms) {
+  if(hasFterms || P->sosHessian) {
     arr H_x;
     P->getFHessian(H_x, x);
     H_x.sparse();
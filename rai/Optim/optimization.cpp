@@ -55,7 +55,7 @@ double Conv_NLP_ScalarProblem::scalar(arr& g, arr& H, const arr& x){
     }
     H = comp_At_A(tmp); //Gauss-Newton type!
 
-    if(hasF) { //For f-terms, the Hessian must be given explicitly, and is not \propto J^T J
+    if(hasF || P->sosHessian) { //For f-terms, the Hessian must be given explicitly, and is not \propto J^T J
       arr fH;
       P->getFHessian(fH, x);
       if(fH.N) H += fH;
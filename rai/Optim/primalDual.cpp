@@ -123,9 +123,8 @@ double PrimalDualProblem::primalDual(arr& r, arr& R, const arr& x_lambda) {
         if(!sparse) {
           for(uint j=0; j<x.N; j++) R(j, n) = L.J_x(i, j);
         } else {
-          uintA& row = LJx_sparse->rows(i);
-          for(uint j=0; j<row.d0; j++) {
-            Rsparse->addEntry(row(j, 0), n) = LJx_sparse->Z.elem(row(j, 1));
+          for(int k=LJx_sparse->rowPtr(i); k<LJx_sparse->rowPtr(i+1); k++) {
+            Rsparse->addEntry(LJx_sparse->rowCol(k), n) = LJx_sparse->Z.elem(LJx_sparse->rowMem(k));
           }
         }
         n++;
@@ -155,9 +154,8 @@ double PrimalDualProblem::primalDual(arr& r, arr& R, const arr& x_lambda) {
         if(!sparse) {
           for(uint j=0; j<x.N; j++) R(n, j) = L.J_x(i, j);
         } else {
-          uintA& row = LJx_sparse->rows(i);
-          for(uint j=0; j<row.d0; j++) {
-            Rsparse->addEntry(n, row(j, 0)) = LJx_sparse->Z.elem(row(j, 1));
+          for(int k=LJx_sparse->rowPtr(i); k<LJx_sparse->rowPtr(i+1); k++) {
+            Rsparse->addEntry(n, LJx_sparse->rowCol(k)) = LJx_sparse->Z.elem(LJx_sparse->rowMem(k));
           }
         }
         n++;
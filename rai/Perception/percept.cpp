@@ -79,7 +79,7 @@ void PercMesh::syncWith(rai::Configuration& K) {
   rai::Frame* f = K.getFrame(STRING("perc_"<<id), false);
   if(!f) {
     f = new rai::Frame(K);
-    f->name <<"perc_" <<id;
+    f->setName(STRING("perc_" <<id));
     new rai::Shape(*f);
     f->shape->type() = rai::ST_mesh;
     f->ats->getNew<int>("label") = 0x80+id;
@@ -132,7 +132,7 @@ void PercPlane::syncWith(rai::Configuration& K) {
   if(not body) {
     //cout << plane_name << " does not exist yet; adding it..." << endl;
     body = new rai::Frame(K);
-    body->name = plane_name;
+    body->setName(plane_name);
     rai::Shape* shape = new rai::Shape(*body);
     shape->type() = rai::ST_pointCloud;
 //    shape = new rai::Shape(K, *body);
@@ -210,7 +210,7 @@ void PercBox::syncWith(rai::Configuration& K) {
   if(not body) {
     //cout << plane_name << " does not exist yet; adding it..." << endl;
     body = new rai::Frame(K);
-    body->name = box_name;
+    body->setName(box_name);
     rai::Shape* shape = new rai::Shape(*body);
     shape->type() = rai::ST_box;
   }
@@ -263,7 +263,7 @@ void PercCluster::syncWith(rai::Configuration& K) {
   if(not body) {
     //cout << cluster_name << " does not exist yet; adding it..." << endl;
     body = new rai::Frame(K);
-    body->name = cluster_name;
+    body->setName(cluster_name);
     rai::Shape* shape = new rai::Shape(*body);
     shape->type() = rai::ST_pointCloud;
     shape = new rai::Shape(*body);
@@ -287,7 +287,7 @@ void PercAlvar::syncWith(rai::Configuration& K) {
   if(not body) {
 //    cout << alvar_name << " does not exist yet; adding it..." << endl;
     body = new rai::Frame(K);
-    body->name = alvar_name;
+    body->setName(alvar_name);
     rai::Shape* shape = new rai::Shape(*body);
     shape->type() = rai::ST_marker;
     shape->size = rai::consts(.2, 3);
@@ -304,7 +304,7 @@ void OptitrackBody::syncWith(rai::Configuration& K) {
   if(not body) {
     cout << optitrackbody_name << " does not exist yet; adding it..." << endl;
     body = new rai::Frame(K);
-    body->name = optitrackbody_name;
+    body->setName(optitrackbody_name);
     rai::Shape* shape = new rai::Shape(*body);
     shape->type() = rai::ST_marker;
     shape->size = rai::consts(.1, 3);
@@ -321,7 +321,7 @@ void OptitrackMarker::syncWith(rai::Configuration& K) {
   if(not body) {
     cout << optitrackmarker_name << " does not exist yet; adding it..." << endl;
     body = new rai::Frame(K);
-    body->name = optitrackmarker_name;
+    body->setName(optitrackmarker_name);
     rai::Shape* shape = new rai::Shape(*body);
     shape->type() = rai::ST_sphere;
     shape->size = rai::consts(.03, 3);
@@ -253,6 +253,20 @@ many mapping refer to one or several frames, which need to be specified using fr
   }, "TODO remove -> use feature directly"
       )
 
+  .def("batchEval", [](shared_ptr<rai::Configuration>& self, FeatureSymbol fs, const std::vector<std::string>& frames, const pybind11::array_t<double>& Q, bool jacobians) {
+    arr J;
+    arr y = self->batchEval(fs, strvec2StringA(frames), numpy2arr<double>(Q), (jacobians?J:NoArr));
+    if(!jacobians) return pybind11::make_tuple(arr2numpy(y), pybind11::none());
+    return pybind11::make_tuple(arr2numpy(y), arr2numpy(J));
+  },
+  "evaluate a feature for each row of Q (a (N, D)-array of joint states) in parallel, without changing the configuration; \
+returns the (N, dim)-array of values and (if jacobians) the (N, dim, D)-array of Jacobians",
+  pybind11::arg("featureSymbol"),
+  pybind11::arg("frameNames"),
+  pybind11::arg("Q"),
+  pybind11::arg("jacobians")=true
+      )
+
   .def("selectJoints", [](shared_ptr<rai::Configuration>& self, const std::vector<std::string>& jointNames, bool notThose) {
     // TODO: this is joint groups
     // TODO: maybe call joint groups just joints and joints DOFs
@@ -264,6 +264,11 @@ void TEST(Autodiff){
   checkOperation(x/a);
   checkOperation(a/x);
   checkOperation(-x);
+  checkOperation(2.*x + a*3. - x/2.);
+  checkOperation(a + (x-a)*2.);
+  checkOperation(-(x+a));
+  checkOperation((x+a)%a);
+  checkOperation(1. - (x+1.));
   checkOperation(~x);
   checkOperation(~x*a);
   checkOperation(~a*x);
@@ -385,6 +390,105 @@ void TEST(MemoryBound){
 
 //===========================================================================
 
+/// the temporaries of a function called within an ArenaScope
+static arr arenaEvaluation(arr& outer){
+  arr a = rand(100); //(larger than the inline memory of small arrays)
+  CHECK(a.isArena, "");
+  arr b = a + 1.;
+  CHECK(b.isArena, "");
+  CHECK_ZERO(maxDiff(b-a, ones(100)), 1e-10, "");
+  for(uint i=0;i<100;i++) b.append(i); //grows within and beyond the chunk
+  CHECK_EQ(b.N, 200, "");
+  CHECK_EQ(b(199), 99., "");
+  outer.append(4.); //arrays of the caller are not temporaries of the scope
+  CHECK(!outer.isArena, "");
+  arr big(100000); //too large for the arena
+  CHECK(!big.isArena, "");
+  CHECK(arr(zeros(50)).isArena, "");
+  static arr cache; //long-lived arrays never pin the arena...
+  cache = a;
+  CHECK(!cache.isArena, "");
+  arr c = zeros(50);
+  std::unique_ptr<arr> member(new arr(std::move(c))); //...also when arena memory is moved into them
+  CHECK(!member->isArena, "");
+  CHECK_EQ(member->N, 50, "");
+  {
+    rai::ArenaSuspend heap;
+    arr d = zeros(50);
+    CHECK(!d.isArena, "");
+  }
+  arr moved = b;
+  moved.append(-1.);
+  return moved;
+}
+
+void TEST(Arena){
+  cout <<"\n*** arena allocation\n";
+  arr (*volatile evaluation)(arr&) = arenaEvaluation; //(called, never inlined: only locals of functions called within a scope use it)
+  arr outer = ones(20);
+  arr result;
+  {
+    rai::ArenaScope arena;
+    result = evaluation(outer);
+    {
+      rai::ArenaScope inner;
+      evaluation(outer);
+    }
+    CHECK(!result.isArena, "");
+  }
+  CHECK_EQ(outer.N, 22, "");
+  CHECK_EQ(result.N, 201, "");
+  CHECK_EQ(result(199), 99., "");
+  CHECK_EQ(result(200), -1., "");
+}
+
+//===========================================================================
+
+void TEST(SmallArrays){
+  cout <<"\n*** inline memory of small arrays\n";
+  arr a = {1., 2., 3.};
+  CHECK(a.isSmall(), "");
+  arr b = std::move(a); //copies the inline memory
+  CHECK(b.isSmall() && !a.N && !a.p, "");
+  CHECK_EQ(b, arr({1., 2., 3.}), "");
+  for(uint i=0;i<20;i++) b.append(i); //inline -> heap
+  CHECK(!b.isSmall(), "");
+  CHECK_EQ(b(2), 3., "");
+  CHECK_EQ(b(22), 19., "");
+  b.resize(4); //small down-size: stays on the heap
+  b.clear();
+  b = {4., 5.};
+  CHECK(b.isSmall(), "");
+  arr r;
+  const arr& cb = b;
+  r.referTo(cb); //views alias the inline memory and leave the (const) source untouched
+  CHECK(r.isReference && r.p==b.p && b.isSmall(), "");
+  r(1) = 6.;
+  CHECK_EQ(b(1), 6., "");
+  arr m = ones(2, 3);
+  CHECK(m.isSmall(), "");
+  const arr& cm = m;
+  arr row = cm[1];
+  CHECK(m.isSmall() && row.p==m.p+3, "");
+  row(2) = 8.;
+  CHECK_EQ(m(1, 2), 8., "");
+  arr c;
+  c.takeOver(b); //copies the inline memory: views keep the old one
+  CHECK(!b.N, "");
+  CHECK_EQ(c, arr({4., 6.}), "");
+  arr d(4,4);
+  CHECK(d.isSmall(), "");
+  arr e(3,10);
+  CHECK(!e.isSmall(), "");
+  uintA u = {1, 2, 3};
+  CHECK(u.isSmall(), "");
+  StringA s = {"a", "b"}; //not memmove-able: always on the heap
+  CHECK(!s.isSmall(), "");
+  CHECK(sizeof(StringA)<sizeof(arr), "only scalar types have inline memory");
+}
+
+//===========================================================================
+
 void TEST(BinaryIO){
   cout <<"\n*** acsii and binary IO\n";
   arr a,b; a.resize(1000,100); rndUniform(a,0.,1.,false);
@@ -663,6 +767,18 @@ void TEST(Inverse){
   cout <<" error = " <<maxDiff(A*invA, I) <<endl;
   CHECK_ZERO(maxDiff(A*invA, I), 1e-6, "lapack SymDefPos inverse failed");
 
+  //-- multiple right-hand sides: a single factorization
+  arr B = rand(m, 7);
+  arr X = lapack_Ainv_b_sym(A, B);
+  CHECK_EQ(X.d0, m, "");
+  CHECK_EQ(X.d1, B.d1, "");
+  for(uint j=0;j<B.d1;j++) CHECK_ZERO(maxDiff(X.col(j), lapack_Ainv_b_sym(A, B.col(j))), 1e-6, "multi-rhs solve differs");
+  arr As = A.sub(0,49,0,49);
+  arr Bs = B.sub(0,49,0,-1);
+  arr Xs = lapack_Ainv_b_sym(As, Bs);
+  As.sparse();
+  CHECK_ZERO(maxDiff(lapack_Ainv_b_sym(As, Bs), Xs), 1e-6, "sparse multi-rhs solve differs");
+
   CHECK(t_lapack < t_native, "lapack matrix inverse slower than native");
   CHECK(t_symPosDef < t_lapack, "symposdef matrix inverse slower than general");
 }
@@ -842,6 +958,83 @@ void TEST(SparseMatrix){
     sparseProduct(D, A, B);
     CHECK_EQ(C, D, "");
   }
+
+  //-- compressed row/column index: products against dense reference, including duplicate entries
+  for(uint k=0;k<20;k++){
+    arr J(30,20);
+    rndInteger(J,-2,2);
+    arr x = rand(J.d0);
+    arr Jdense = J;
+    J.sparse();
+    arr Jd(1, J.d1);
+    rndInteger(Jd, -1, 1);
+    J.sparse().add(Jd, 2, 0); //adds duplicate entries to row 2
+    Jdense[2] += Jd[0];
+    J.sparse().setupRowsCols();
+    J.sparse().checkConsistency();
+    CHECK_ZERO(maxDiff(J.sparse().At_x(x), ~Jdense*x), 1e-10, "");
+    arr H = comp_At_A(J);
+    CHECK(H.sparse().isCSC, "");
+    CHECK_ZERO(maxDiff(H.sparse().unsparse(), ~Jdense*Jdense), 1e-10, "");
+    Eigen::SparseMatrix<double> Jeig = conv_sparseArr2sparseEigen(J.sparse());
+    CHECK_EQ(conv_sparseEigen2sparseArr(Jeig).sparse().unsparse(), Jdense, "");
+    CHECK_EQ(J.sparse().elem(5,3), Jdense(5,3), "");
+  }
+
+  //-- a stale index (elems changed directly, without clearRowsCols) is detected
+  {
+    arr J = eye(4);
+    rai::SparseMatrix& S = J.sparse();
+    S.setupRowsCols();
+    S.elems.resizeCopy(3, 2);
+    bool caught=false;
+    try { S.At_x(ones(4)); } catch(...) { caught=true; }
+    CHECK(caught, "stale row/col index not detected");
+  }
+
+  //-- multithreaded J^T J and J^T x: bitwise identical for any thread count
+  {
+    arr J = zeros(3000, 600);
+    for(uint i=0;i<J.d0;i++) for(uint j=0;j<6;j++) J(i, (i/5+j*7)%J.d1) = rnd.gauss();
+    arr x = rand(J.d0);
+    J.sparse();
+    rai::sparseNumThreads=1;
+    arr H1 = comp_At_A(J), g1 = comp_At_x(J, x);
+    rai::sparseNumThreads=4;
+    arr H4 = comp_At_A(J), g4 = comp_At_x(J, x);
+    rai::sparseNumThreads=0;
+    CHECK_EQ(H1.sparse().elems, H4.sparse().elems, "");
+    CHECK(!memcmp(H1.p, H4.p, H1.N*H1.sizeT), "At_A depends on the thread count");
+    CHECK(!memcmp(g1.p, g4.p, g1.N*g1.sizeT), "At_x depends on the thread count");
+
+    //called from within a parallel region, where OpenMP provides fewer threads than requested
+    rai::sparseNumThreads=4;
+    arr Hs[3];
+    #pragma omp parallel for num_threads(3)
+    for(int k=0;k<3;k++) Hs[k] = comp_At_A(J);
+    rai::sparseNumThreads=0;
+    for(uint k=0;k<3;k++){
+      CHECK_EQ(Hs[k].sparse().elems, H1.sparse().elems, "");
+      CHECK(!memcmp(Hs[k].p, H1.p, H1.N*H1.sizeT), "At_A within a parallel region differs");
+    }
+  }
+
+  //-- persistent symmetric solver: analyze once, only refactorize for new values of the same pattern
+  rai::SparseSymSolver solver;
+  for(uint k=0;k<10;k++){
+    uint w = (k<5 ? 1 : 2); //banded Hessian; change the band width (=pattern) once
+    arr H = zeros(20,20);
+    for(uint i=0;i<H.d0;i++) for(uint j=i+1;j<H.d1 && j<=i+w;j++) H(i,j) = H(j,i) = rnd.uni(-1.,1.);
+    addDiag(H, 2.*w+1.);
+    arr b = rand(H.d0);
+    arr x = lapack_Ainv_b_sym(H, b);
+    H.sparse();
+    arr y = solver.solve(H, b);
+    CHECK_ZERO(maxDiff(x, y), 1e-10, "");
+  }
+  cout <<"SparseSymSolver: #analyze=" <<solver.numAnalyze <<" #factorize=" <<solver.numFactorize <<endl;
+  CHECK_EQ(solver.numAnalyze, 2, "");
+  CHECK_EQ(solver.numFactorize, 10, "");
 }
 
 //===========================================================================
@@ -917,6 +1110,146 @@ void TEST(EigenValues){
 
 //===========================================================================
 
+void TEST(SimdKernels){
+  cout <<"\n*** SIMD kernels vs scalar fallback\n";
+  int best = rai::setSimdLevel(-1);
+  cout <<"cpu simd level: " <<best <<endl;
+  for(uint n : {0u, 1u, 15u, 16u, 17u, 31u, 100u, 1001u}){
+    arr x = randn(n), y = randn(n);
+    rai::setSimdLevel(0);
+    double sqr=sumOfSqr(x), dot=scalarProduct(x,y), amax=absMax(x), sabs=sumOfAbs(x), spos=sumOfPos(x);
+    arr xpy = x+y, xmy = x-y, xty = x%y, xs = x*3.;
+    for(int level=0; level<=best; level++){
+      CHECK_EQ(rai::setSimdLevel(level), level, "");
+      double eps = 1e-12*(1.+n);
+      CHECK_ZERO(sumOfSqr(x)-sqr, eps, "");
+      CHECK_ZERO(scalarProduct(x,y)-dot, eps, "");
+      CHECK_EQ(absMax(x), amax, "");
+      if(n) for(uint i:{0u, n/2, n-1}) { //absMax propagates NaN, wherever it is
+        arr xnan = x;
+        xnan(i) = NAN;
+        CHECK(std::isnan(absMax(xnan)), "absMax drops NaN at " <<i <<" of " <<n);
+      }
+      CHECK_ZERO(sumOfAbs(x)-sabs, eps, "");
+      CHECK_ZERO(sumOfPos(x)-spos, eps, "");
+      CHECK_EQ(x+y, xpy, "");
+      CHECK_EQ(x-y, xmy, "");
+      CHECK_EQ(x%y, xty, "");
+      CHECK_EQ(x*3., xs, "");
+    }
+  }
+  rai::setSimdLevel(-1);
+}
+
+//===========================================================================
+
+void TEST(RvalueOperators){
+  cout <<"\n*** in-place operators on temporaries\n";
+  arr a = randn(100), b = randn(100), c = randn(100);
+  arr ref = a;
+  ref += 2.*b;
+  ref -= c/3.;
+  arr x = a + 2.*b - c/3.;
+  CHECK_ZERO(maxDiff(x, ref), 1e-12, "");
+
+  //a temporary's buffer is handed on
+  arr t = a+b;
+  double* p = t.p;
+  arr y = std::move(t)*2. + c;
+  CHECK_EQ(y.p, p, "");
+
+  //references are never modified
+  arr M = randn(3,100);
+  arr M0 = M;
+  arr z = M[1] + a;
+  z = -M[2];
+  z = M[0]*3.;
+  z = M[1]%b;
+  CHECK_EQ(M, M0, "");
+
+  //the result has the dimensions of the left operand, as for lvalues
+  arr A = randn(3,4), v = randn(12);
+  arr s1 = A + v, s2 = A + arr(v);
+  CHECK_EQ(s2.dim(), A.dim(), "");
+  CHECK_EQ(s1, s2, "");
+}
+
+//===========================================================================
+
+void TEST(FixedArr){
+  cout <<"\n*** fixed-size arrays\n";
+  rai::FixedArr<3,4> A(randn(3,4));
+  rai::FixedArr<4> x = {1., 2., 3., 4.};
+  arr y = A.view() * x.view();
+  CHECK_ZERO(maxDiff((A*x).view(), y), 1e-12, "");
+  rai::FixedArr<4,2> B(randn(4,2));
+  CHECK_ZERO(maxDiff((A*B).view(), A.view()*B.view()), 1e-12, "");
+  rai::FixedArr<3> z = {.1, -.2, .3};
+  CHECK_ZERO(maxDiff(crossProduct(A, z).view(), crossProduct(A.view(), z.view())), 1e-12, "");
+
+  //views refer to the fixed memory
+  arr v = A.view();
+  CHECK(v.isReference && v.nd==2 && v.d1==4, "");
+  v(1,2) = 7.;
+  CHECK_EQ(A(1,2), 7., "");
+
+  //block writes into dense and sparse matrices
+  arr J = zeros(3,10), S;
+  S.sparse().resize(3, 10, 0);
+  setMatrixBlock(J, A, 0, 3);
+  setMatrixBlock(S, A, 0, 3);
+  setMatrixBlock(J, z, 0, 9);
+  setMatrixBlock(S, z, 0, 9);
+  CHECK_ZERO(maxDiff(J, S.sparse().unsparse()), 0., "");
+  CHECK_ZERO(maxDiff(J.sub(0,-1,3,6), A.copy()), 0., "");
+}
+
+//===========================================================================
+
+void TEST(MappedArrays){
+  cout <<"\n*** memory-mapped binary array files\n";
+  arr x = randn(100, 7);
+  floatA f = rai::convert<float>(randn(120));
+  f.reshape(4, 5, 6);
+  uintA u = {3, 1, 4};
+  byteA e;
+  rai::MappedArraysWriter().add("x", x).add("f", f).add("u", u).add("empty", e).write("z.arrs");
+  CHECK(rai::MappedArrays::isMappedFile("z.arrs"), "");
+  CHECK(!rai::MappedArrays::isMappedFile("z.bin"), "");
+
+  {
+    rai::MappedArrays M("z.arrs");
+    arr x2;
+    x2.referTo(M.get<double>("x")); //(arr x2 = ... converts, which copies)
+    CHECK(x2.isReference && ((size_t)x2.p)%64==0, "data should be referred to, aligned");
+    CHECK_EQ(x2, x, "");
+    floatA f2 = M.get<float>("f"); //initialization moves the reference
+    CHECK(f2.isReference, "");
+    CHECK_EQ(f2.nd, 3, "");
+    CHECK_EQ(f2, f, "");
+    CHECK_EQ(M.get<uint>("u"), u, "");
+    CHECK_EQ(M.get<byte>("empty").N, 0, "");
+    CHECK(!M.has("y"), "");
+    floatA f3;
+    f3 = M.get<float>("f"); //assignment copies
+    CHECK(!f3.isReference, "");
+    CHECK_EQ(M.entries[2].type, "u4", "type tags are compiler-independent");
+    bool thrown=false;
+    try { M.get<int>("u"); } catch(...) { thrown=true; }
+    CHECK(thrown, "reading uint data as int must fail");
+  }
+
+  {
+    rai::MappedArrays M("z.arrs", true); //copy-on-write: private modifications
+    arr x2;
+    x2.referTo(M.get<double>("x"));
+    x2(0,0) = 123.;
+    CHECK_EQ(M.get<double>("x")(0,0), 123., "");
+  }
+  rai::MappedArrays M("z.arrs");
+  CHECK_EQ(M.get<double>("x")(0,0), x(0,0), "the file must be unchanged");
+}
+
 int MAIN(int argc, char **argv){
   rai::initCmdLine(argc, argv);
 
@@ -932,7 +1265,13 @@ int MAIN(int argc, char **argv){
   testMatlab();
   testException();
   testMemoryBound();
+  testArena();
+  testSmallArrays();
+  testSimdKernels();
+  testRvalueOperators();
+  testFixedArr();
   testBinaryIO();
+  testMappedArrays();
   testExpression();
   testPermutation();
   testGnuplot();
@@ -0,0 +1,55 @@
+#include <Core/array.h>
+#include <Core/util.h>
+
+#include <iomanip>
+
+using namespace std;
+
+//===========================================================================
+//
+// micro-benchmark of the SIMD kernels in arrayDouble.cpp against the scalar loops
+//
+
+double bench(const char* name, uint n, uint reps, const function<void()>& f){
+  f(); //warm up
+  rai::timerStart(true);
+  for(uint k=0;k<reps;k++) f();
+  double t=rai::timerRead();
+  cout <<"  " <<setw(12) <<left <<name <<" n=" <<setw(8) <<n <<setw(10) <<1e9*t/(double(reps)*n) <<"ns/elem" <<endl;
+  return t;
+}
+
+void benchAll(uint n, uint reps){
+  arr x = randn(n), y = randn(n);
+  double s=0.;
+  bench("sumOfSqr", n, reps, [&](){ s+=sumOfSqr(x); });
+  bench("scalarProd", n, reps, [&](){ s+=scalarProduct(x,y); });
+  bench("absMax", n, reps, [&](){ s+=absMax(x); });
+  bench("sumOfAbs", n, reps, [&](){ s+=sumOfAbs(x); });
+  bench("sumOfPos", n, reps, [&](){ s+=sumOfPos(x); });
+  bench("+=", n, reps, [&](){ x+=y; });
+  bench("-=", n, reps, [&](){ x-=y; });
+  bench("%", n, reps, [&](){ x=x%y; });
+  bench("*scalar", n, reps, [&](){ x*=1.0000001; });
+  cout <<"  (checksum " <<s <<")" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc, argv);
+
+  int best = rai::setSimdLevel(-1);
+  for(uint n : {64u, 1000u, 100000u, 4000000u}){
+    uint reps = 400000000u/n;
+    if(reps>2000000u) reps=2000000u;
+    for(int level=0; level<=best; level++){
+      rai::setSimdLevel(level);
+      cout <<"--- simd level " <<level <<(level==0?" (scalar)":level==1?" (AVX2)":" (AVX-512)") <<endl;
+      benchAll(n, reps/10);
+    }
+  }
+  rai::setSimdLevel(-1);
+
+  return 0;
+}
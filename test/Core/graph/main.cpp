@@ -161,6 +161,106 @@ void TEST(Manual){
 
 //===========================================================================
 
+void TEST(KeyIndex){
+  rai::Graph G;
+  G.newNode<double>("a", {}, 1.);
+  G.indexKeys(); //opt-in, also after nodes were added
+  G.newNode<bool>("b", {}, true);
+  G.newNode<double>("a", {}, 2.);
+  rai::Node *c = G.newNode<double>("c", {}, 3.);
+
+  //first match in list order, also with type filter
+  CHECK_EQ(G.get<double>("a"), 1., "");
+  CHECK_EQ(G.findNodes("a").N, 2, "");
+  CHECK(!G.findNodeOfType(typeid(bool), "a"), "");
+  CHECK_EQ(G.findNodesOfType(typeid(double), "a").N, 2, "");
+
+  //deletion keeps list order
+  delete G.findNode("a");
+  CHECK_EQ(G.get<double>("a"), 2., "");
+  G.newNode<double>("a", {}, 4.);
+  CHECK_EQ(G.get<double>("a"), 2., "");
+
+  //renaming
+  c->setKey("a");
+  CHECK_EQ(G.get<double>("a"), 2., "");
+  CHECK_EQ(G.findNodes("a").N, 3, "");
+  CHECK(!G.findNode("c"), "");
+  G.findNode("b")->setKey("x");
+  CHECK(G.findNode("x"), "");
+  CHECK(!G.findNode("b"), "");
+
+  //many nodes
+  for(uint i=0;i<10000;i++) G.newNode<uint>(STRING("n" <<i), {}, i);
+  for(uint i=0;i<10000;i+=97) CHECK_EQ(G.get<uint>(STRING("n" <<i)), i, "");
+  G.checkConsistency();
+
+  //copies inherit the index, lookups agree with an unindexed graph
+  rai::Graph B = G, U;
+  CHECK(B.isKeyIndexed, "");
+  U.copy(G);  U.isKeyIndexed=false;  U.keyIndex.clear();
+  for(const char* key:{"a", "x", "b", "n97", "n10000"}) CHECK_EQ(B.findNodes(key).N, U.findNodes(key).N, key);
+  CHECK_EQ(B.findNodes("a").N, 3, "");
+  G.clear();
+  CHECK(!G.findNode("a"), "");
+  CHECK_EQ(B.get<double>("a"), 2., "");
+}
+
+//===========================================================================
+
+void TEST(ParseBuffer){
+  //the buffer parser (files) agrees with the stream parser
+  {
+    rai::Graph A("example.g"), B;
+    std::ifstream fil("example.g");
+    B.read(fil);
+    rai::String a, b;
+    a <<A;  b <<B;
+    CHECK(a==b, "buffer parser differs from the stream parser");
+  }
+
+  //a small knowledge base with top-level subgraphs large enough to be parsed in parallel
+  rai::String kb;
+  for(uint k=0;k<8;k++) {
+    kb <<"obj" <<k <<" { pose:<t(" <<k <<" 0 0)>, size:[.1 .2 .3], color:blue }\n";
+    kb <<"kb" <<k <<" {\n";
+    for(uint i=0;i<100;i++) kb <<"  fact" <<i <<":[" <<i <<' ' <<k <<" 3.5e-1], names:[\"f" <<i <<"\" \"g\"], tags:[a, b], sub:{ a:" <<i <<" b:'file.txt' c! }\n";
+    kb <<"}\n";
+  }
+  std::ofstream("z.parse.g") <<kb;
+
+  rai::Graph A, B, C;
+  std::ifstream fil("z.parse.g");
+  A.read(fil);
+  rai::graphParseThreads=1;
+  B.read(FILE("z.parse.g"));
+  rai::graphParseThreads=4; //more threads than cores: string arrays must not share parser state
+  C.read(FILE("z.parse.g"));
+  rai::graphParseThreads=0;
+
+  rai::String a, b, c;
+  a <<A;  b <<B;  c <<C;
+  CHECK_EQ(A.N, 16, "");
+  CHECK(a==b, "buffer parser differs from the stream parser");
+  CHECK(a==c, "parallel parser differs from the stream parser");
+
+  //errors in a parallel parsed subgraph report the line in the file
+  kb.clear() <<"x:1\nkb {\n";
+  for(uint i=0;i<100;i++) kb <<"  fact" <<i <<":[" <<i <<" 3.5e-1], name:\"f" <<i <<"\", sub:{ a:" <<i <<" c! }\n";
+  kb <<"  bad:[1 2; 3]\n}\n";
+  std::ofstream("z.parse.g") <<kb;
+  for(uint threads:{1, 0}) {
+    rai::graphParseThreads=threads;
+    rai::lineCount=1;
+    rai::String msg;
+    try { rai::Graph D("z.parse.g"); } catch(const std::exception& ex) { msg=ex.what(); }
+    CHECK(msg.contains(rai::String("line=103")), "wrong line in error '" <<msg <<"'");
+  }
+  rai::graphParseThreads=0;
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -172,6 +272,8 @@ int MAIN(int argc, char** argv){
   testDot();
 
   testManual();
+  testKeyIndex();
+  testParseBuffer();
 
   return 0;
 }
@@ -0,0 +1,104 @@
+x:1
+kb {
+  fact0:[0 3.5e-1], name:"f0", sub:{ a:0 c! }
+  fact1:[1 3.5e-1], name:"f1", sub:{ a:1 c! }
+  fact2:[2 3.5e-1], name:"f2", sub:{ a:2 c! }
+  fact3:[3 3.5e-1], name:"f3", sub:{ a:3 c! }
+  fact4:[4 3.5e-1], name:"f4", sub:{ a:4 c! }
+  fact5:[5 3.5e-1], name:"f5", sub:{ a:5 c! }
+  fact6:[6 3.5e-1], name:"f6", sub:{ a:6 c! }
+  fact7:[7 3.5e-1], name:"f7", sub:{ a:7 c! }
+  fact8:[8 3.5e-1], name:"f8", sub:{ a:8 c! }
+  fact9:[9 3.5e-1], name:"f9", sub:{ a:9 c! }
+  fact10:[10 3.5e-1], name:"f10", sub:{ a:10 c! }
+  fact11:[11 3.5e-1], name:"f11", sub:{ a:11 c! }
+  fact12:[12 3.5e-1], name:"f12", sub:{ a:12 c! }
+  fact13:[13 3.5e-1], name:"f13", sub:{ a:13 c! }
+  fact14:[14 3.5e-1], name:"f14", sub:{ a:14 c! }
+  fact15:[15 3.5e-1], name:"f15", sub:{ a:15 c! }
+  fact16:[16 3.5e-1], name:"f16", sub:{ a:16 c! }
+  fact17:[17 3.5e-1], name:"f17", sub:{ a:17 c! }
+  fact18:[18 3.5e-1], name:"f18", sub:{ a:18 c! }
+  fact19:[19 3.5e-1], name:"f19", sub:{ a:19 c! }
+  fact20:[20 3.5e-1], name:"f20", sub:{ a:20 c! }
+  fact21:[21 3.5e-1], name:"f21", sub:{ a:21 c! }
+  fact22:[22 3.5e-1], name:"f22", sub:{ a:22 c! }
+  fact23:[23 3.5e-1], name:"f23", sub:{ a:23 c! }
+  fact24:[24 3.5e-1], name:"f24", sub:{ a:24 c! }
+  fact25:[25 3.5e-1], name:"f25", sub:{ a:25 c! }
+  fact26:[26 3.5e-1], name:"f26", sub:{ a:26 c! }
+  fact27:[27 3.5e-1], name:"f27", sub:{ a:27 c! }
+  fact28:[28 3.5e-1], name:"f28", sub:{ a:28 c! }
+  fact29:[29 3.5e-1], name:"f29", sub:{ a:29 c! }
+  fact30:[30 3.5e-1], name:"f30", sub:{ a:30 c! }
+  fact31:[31 3.5e-1], name:"f31", sub:{ a:31 c! }
+  fact32:[32 3.5e-1], name:"f32", sub:{ a:32 c! }
+  fact33:[33 3.5e-1], name:"f33", sub:{ a:33 c! }
+  fact34:[34 3.5e-1], name:"f34", sub:{ a:34 c! }
+  fact35:[35 3.5e-1], name:"f35", sub:{ a:35 c! }
+  fact36:[36 3.5e-1], name:"f36", sub:{ a:36 c! }
+  fact37:[37 3.5e-1], name:"f37", sub:{ a:37 c! }
+  fact38:[38 3.5e-1], name:"f38", sub:{ a:38 c! }
+  fact39:[39 3.5e-1], name:"f39", sub:{ a:39 c! }
+  fact40:[40 3.5e-1], name:"f40", sub:{ a:40 c! }
+  fact41:[41 3.5e-1], name:"f41", sub:{ a:41 c! }
+  fact42:[42 3.5e-1], name:"f42", sub:{ a:42 c! }
+  fact43:[43 3.5e-1], name:"f43", sub:{ a:43 c! }
+  fact44:[44 3.5e-1], name:"f44", sub:{ a:44 c! }
+  fact45:[45 3.5e-1], name:"f45", sub:{ a:45 c! }
+  fact46:[46 3.5e-1], name:"f46", sub:{ a:46 c! }
+  fact47:[47 3.5e-1], name:"f47", sub:{ a:47 c! }
+  fact48:[48 3.5e-1], name:"f48", sub:{ a:48 c! }
+  fact49:[49 3.5e-1], name:"f49", sub:{ a:49 c! }
+  fact50:[50 3.5e-1], name:"f50", sub:{ a:50 c! }
+  fact51:[51 3.5e-1], name:"f51", sub:{ a:51 c! }
+  fact52:[52 3.5e-1], name:"f52", sub:{ a:52 c! }
+  fact53:[53 3.5e-1], name:"f53", sub:{ a:53 c! }
+  fact54:[54 3.5e-1], name:"f54", sub:{ a:54 c! }
+  fact55:[55 3.5e-1], name:"f55", sub:{ a:55 c! }
+  fact56:[56 3.5e-1], name:"f56", sub:{ a:56 c! }
+  fact57:[57 3.5e-1], name:"f57", sub:{ a:57 c! }
+  fact58:[58 3.5e-1], name:"f58", sub:{ a:58 c! }
+  fact59:[59 3.5e-1], name:"f59", sub:{ a:59 c! }
+  fact60:[60 3.5e-1], name:"f60", sub:{ a:60 c! }
+  fact61:[61 3.5e-1], name:"f61", sub:{ a:61 c! }
+  fact62:[62 3.5e-1], name:"f62", sub:{ a:62 c! }
+  fact63:[63 3.5e-1], name:"f63", sub:{ a:63 c! }
+  fact64:[64 3.5e-1], name:"f64", sub:{ a:64 c! }
+  fact65:[65 3.5e-1], name:"f65", sub:{ a:65 c! }
+  fact66:[66 3.5e-1], name:"f66", sub:{ a:66 c! }
+  fact67:[67 3.5e-1], name:"f67", sub:{ a:67 c! }
+  fact68:[68 3.5e-1], name:"f68", sub:{ a:68 c! }
+  fact69:[69 3.5e-1], name:"f69", sub:{ a:69 c! }
+  fact70:[70 3.5e-1], name:"f70", sub:{ a:70 c! }
+  fact71:[71 3.5e-1], name:"f71", sub:{ a:71 c! }
+  fact72:[72 3.5e-1], name:"f72", sub:{ a:72 c! }
+  fact73:[73 3.5e-1], name:"f73", sub:{ a:73 c! }
+  fact74:[74 3.5e-1], name:"f74", sub:{ a:74 c! }
+  fact75:[75 3.5e-1], name:"f75", sub:{ a:75 c! }
+  fact76:[76 3.5e-1], name:"f76", sub:{ a:76 c! }
+  fact77:[77 3.5e-1], name:"f77", sub:{ a:77 c! }
+  fact78:[78 3.5e-1], name:"f78", sub:{ a:78 c! }
+  fact79:[79 3.5e-1], name:"f79", sub:{ a:79 c! }
+  fact80:[80 3.5e-1], name:"f80", sub:{ a:80 c! }
+  fact81:[81 3.5e-1], name:"f81", sub:{ a:81 c! }
+  fact82:[82 3.5e-1], name:"f82", sub:{ a:82 c! }
+  fact83:[83 3.5e-1], name:"f83", sub:{ a:83 c! }
+  fact84:[84 3.5e-1], name:"f84", sub:{ a:84 c! }
+  fact85:[85 3.5e-1], name:"f85", sub:{ a:85 c! }
+  fact86:[86 3.5e-1], name:"f86", sub:{ a:86 c! }
+  fact87:[87 3.5e-1], name:"f87", sub:{ a:87 c! }
+  fact88:[88 3.5e-1], name:"f88", sub:{ a:88 c! }
+  fact89:[89 3.5e-1], name:"f89", sub:{ a:89 c! }
+  fact90:[90 3.5e-1], name:"f90", sub:{ a:90 c! }
+  fact91:[91 3.5e-1], name:"f91", sub:{ a:91 c! }
+  fact92:[92 3.5e-1], name:"f92", sub:{ a:92 c! }
+  fact93:[93 3.5e-1], name:"f93", sub:{ a:93 c! }
+  fact94:[94 3.5e-1], name:"f94", sub:{ a:94 c! }
+  fact95:[95 3.5e-1], name:"f95", sub:{ a:95 c! }
+  fact96:[96 3.5e-1], name:"f96", sub:{ a:96 c! }
+  fact97:[97 3.5e-1], name:"f97", sub:{ a:97 c! }
+  fact98:[98 3.5e-1], name:"f98", sub:{ a:98 c! }
+  fact99:[99 3.5e-1], name:"f99", sub:{ a:99 c! }
+  bad:[1 2; 3]
+}
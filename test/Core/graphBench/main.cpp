@@ -0,0 +1,52 @@
+#include <Core/graph.h>
+
+//===========================================================================
+//
+// throughput of the stream, buffer, and parallel .g parsers on a ~10MB knowledge base
+//
+
+void writeLargeFile(const char* filename){
+  //flat facts with parents, and large top-level subgraphs
+  std::ofstream fil(filename);
+  for(uint i=0;i<20000;i++) fil <<"obj" <<i <<" { pose:<t(" <<i <<" 0 0)>, size:[.1 .2 .3], color:blue }\n";
+  for(uint i=1;i<20000;i++) fil <<"(obj" <<i-1 <<" obj" <<i <<") { type:edge, w:" <<.5*i <<" }\n";
+  for(uint k=0;k<64;k++) {
+    fil <<"kb" <<k <<" {\n";
+    for(uint i=0;i<2000;i++) fil <<"  fact" <<i <<":[" <<i <<' ' <<k <<" 3.5e-1], name:\"f" <<i <<"\", sub:{ a:" <<i <<" b:'file.txt' c! }\n";
+    fil <<"}\n";
+  }
+}
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  writeLargeFile("z.large.g");
+
+  rai::Graph A, B, C;
+  double time=rai::realTime();
+  std::ifstream fil("z.large.g");
+  A.read(fil);
+  double tStream=rai::realTime()-time;
+
+  rai::graphParseThreads=1;
+  time=rai::realTime();
+  B.read(FILE("z.large.g"));
+  double tBuffer=rai::realTime()-time;
+
+  rai::graphParseThreads=0;
+  time=rai::realTime();
+  C.read(FILE("z.large.g"));
+  double tParallel=rai::realTime()-time;
+
+  double size=std::ifstream("z.large.g", std::ios::ate).tellg();
+  cout <<"parse throughput [MB/s]: stream=" <<1e-6*size/tStream
+       <<" buffer=" <<1e-6*size/tBuffer <<" parallel=" <<1e-6*size/tParallel <<endl;
+
+  rai::String a, b, c;
+  a <<A;  b <<B;  c <<C;
+  CHECK_EQ(A.N, 39999+64, "");
+  CHECK(a==b, "buffer parser differs from the stream parser");
+  CHECK(a==c, "parallel parser differs from the stream parser");
+
+  return 0;
+}
@@ -201,6 +201,136 @@ void TEST(Logging){
   t2.threadClose();
 }
 
+//===========================================================================
+//
+// lock-free single-writer variable: readers never see a torn write
+//
+
+struct JointState {
+  double time;
+  double q[7], qDot[7];
+};
+
+void TEST(SeqVar){
+  SeqVar<JointState> x;
+  std::atomic<bool> stop(false);
+  uint torn=0, reads=0;
+
+  Event ev;
+  ev.listenTo(x);
+
+  std::thread reader([&](){
+    JointState s;
+    while(!stop) {
+      x.get(s);
+      for(uint i=0;i<7;i++) if(s.q[i]!=s.time || s.qDot[i]!=-s.time) torn++;
+      reads++;
+    }
+  });
+
+  uint n=100000;
+  double t=rai::realTime();
+  JointState s;
+  for(uint k=1;k<=n;k++) {
+    s.time = k;
+    for(uint i=0;i<7;i++) { s.q[i]=k; s.qDot[i]=-(double)k; }
+    x.set(s);
+  }
+  t = rai::realTime()-t;
+  stop=true;
+  reader.join();
+
+  cout <<"SeqVar: " <<n <<" writes in " <<t <<"sec, " <<reads <<" concurrent reads" <<endl;
+  CHECK_EQ(torn, 0, "reader saw a partially written state");
+  CHECK_EQ(x.getRevision(), (int)n, "");
+  CHECK_EQ(ev.getStatus(), (int)n, "listening event was not notified on each write");
+  CHECK_EQ(x.get().time, (double)n, "");
+  CHECK(!x.hasNewRevision(), "");
+  ev.stopListening();
+}
+
+//===========================================================================
+//
+// task pool: parallel_for, nested groups, futures, exceptions
+//
+
+int fib(int n){
+  if(n<12) return n<2 ? n : fib(n-1)+fib(n-2);
+  auto a = rai::async([n](){ return fib(n-1); });
+  int b = fib(n-2);
+  return a.get()+b;
+}
+
+void TEST(TaskPool){
+  cout <<"task pool threads: " <<rai::taskPool().numThreads() <<endl;
+
+  //-- parallel_for, nested
+  uint n=200, m=300;
+  arr x(n, m);
+  rai::parallel_for(n, [&x, m](uint i){
+    rai::parallel_for(m, [&x, i](uint j){ x(i,j) = i+j; });
+  });
+  for(uint i=0;i<n;i++) for(uint j=0;j<m;j++) CHECK_EQ(x(i,j), i+j, "");
+
+  //-- task groups
+  std::atomic<int> count(0);
+  {
+    rai::TaskGroup group;
+    for(uint k=0;k<100;k++) group.run([&count](){
+      rai::TaskGroup inner;
+      for(uint l=0;l<10;l++) inner.run([&count](){ count++; });
+      inner.wait();
+    });
+    group.wait();
+  }
+  CHECK_EQ(count, 1000, "");
+
+  //-- futures (recursively spawned)
+  CHECK_EQ(fib(20), 6765, "");
+
+  //-- exceptions are passed to the waiting thread
+  bool caught=false;
+  try {
+    rai::parallel_for(100, [](uint i){ if(i==57) HALT("task " <<i <<" failed (on purpose)"); });
+  } catch(const std::runtime_error& err) {
+    caught=true;
+  }
+  CHECK(caught, "exception was not rethrown");
+}
+
+//===========================================================================
+//
+// jitter statistics of a beating thread
+//
+
+struct BusyThread : Thread {
+  uint overrunEvery;
+  BusyThread(uint _overrunEvery) : Thread("BusyThread", .001), overrunEvery(_overrunEvery) {
+    reportJitter=true;
+  }
+  ~BusyThread(){ threadClose(); }
+  void step(){
+    if(step_count && !(step_count%overrunEvery)) rai::wait(.003); //blow the cycle budget
+  }
+};
+
+void TEST(Jitter){
+  BusyThread th(50);
+  th.threadLoop();
+  while(th.step_count<=120) rai::wait(.01);
+  th.threadClose();
+  JitterStats J = th.jitter.get();
+
+  //only counters are checked, the timing itself depends on the machine load
+  cout <<"jitter: " <<J <<endl;
+  uint64_t n=0;
+  for(uint i=0;i<J.nBins;i++) n+=J.bins[i];
+  CHECK_EQ(n, J.tics, "");
+  CHECK_GE(J.tics, 120, "");
+  CHECK_LE(J.overruns, J.tics, "");
+  CHECK_GE(J.overruns, 2, "the 3ms steps 50 and 100 must overrun the 1ms cycle");
+}
+
 //===========================================================================
 
 int MAIN(int argc,char** argv){
@@ -208,6 +338,9 @@ int MAIN(int argc,char** argv){
 
   testMetronome();
   testThread();
+  testSeqVar();
+  testTaskPool();
+  testJitter();
   testSorter();
 
   testWay0();
@@ -1,5 +1,7 @@
 #include <Core/util.h>
 #include <Core/graph.h>
+#include <Core/profile.h>
+#include <thread>
 #include <math.h>
 #include <iomanip>
 
@@ -105,6 +107,51 @@ void TEST(Inotify){
   }
 }
 
+//===========================================================================
+
+double profiledWork(uint n){
+  RAI_PROFILE_FUNCTION;
+  double x=0.;
+  for(uint k=0;k<5;k++){
+    RAI_PROFILE("inner");
+    for(uint i=0;i<n;i++) x += sin(i);
+    rai::profileCounter("n", n);
+  }
+  return x;
+}
+
+void TEST(Profile){
+  rai::profileEnable(true, true);
+  rai::profileClear();
+  {
+    RAI_PROFILE("outer");
+    profiledWork(10000);
+    std::thread th([](){ profiledWork(20000); });
+    th.join();
+    RAI_PROFILE(typeid(rai::String));
+  }
+
+  rai::String report;
+  rai::profileReport(report);
+  cout <<report;
+  CHECK(report.contains(STRING("outer")) && report.contains(STRING("profiledWork")) && report.contains(STRING("rai::String")), "");
+  rai::profileWriteTrace("z.trace.json");
+
+  rai::Graph trace;
+  trace.readJson(FILE("z.trace.json"));
+  uint zones=0, counters=0;
+  for(rai::Node* n:trace) if(n->isGraph()) { //the traceEvents
+    rai::Graph& e = n->graph();
+    if(e.get<rai::String>("ph")=="X") zones++;
+    if(e.get<rai::String>("ph")=="C") counters++;
+  }
+  CHECK_EQ(zones, 1+2*(1+5)+1, ""); //outer, 2x (profiledWork + 5 inner), String
+  CHECK_EQ(counters, 10, "");
+  rai::profileEnable(false);
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -120,6 +167,7 @@ int MAIN(int argc,char** argv){
   testLogging();
   testException();
   testInotify();
+  testProfile();
 
   return 0;
 }
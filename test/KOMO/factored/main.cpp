@@ -13,7 +13,7 @@ void testFactored(){
   rai::Frame* g = C["gripper"];
   g->ensure_X();
   rai::Frame* g2 = new rai::Frame(C, g);
-  g2->name = "gripperDUP";
+  g2->setName("gripperDUP");
   g2->setShape(rai::ST_box, {.1,.05,.05}); //usually not!
   g2->setParent(C.frames.first(), true);
   g2->setJoint(rai::JT_free);
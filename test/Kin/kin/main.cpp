@@ -199,6 +199,158 @@ void TEST(Copy){
   cout <<"** copy operator success" <<endl;
 }
 
+//===========================================================================
+
+void TEST(CopyInPlace){
+  rai::Configuration G1("kinematicTests.g");
+  G1.addFrame("child1", G1.frames.elem(1)->name);
+  G1.addFrame("child2", G1.frames.elem(1)->name);
+  rai::Configuration G2(G1);
+  CHECK(G2.hasSameStructure(G1), "");
+
+  //modify the copy, then copy the original back: an in-place recopy into the same frames
+  FrameL frames2 = G2.frames;
+  arr q = G2.getJointState();
+  rndGauss(q, .3, true);
+  G2.setJointState(q);
+  G2.frames.elem(3)->set_Q()->pos.x += .5;
+  G2.ensure_proxies();
+  rai::Frame *fork = G2.frames.elem(1); //list its children in reverse order
+  CHECK_GE(fork->children.N, 2, "");
+  fork->children.reverse();
+  G2.copy(G1);
+  CHECK_EQ(G2.frames, frames2, "copy did not reuse the frames");
+  G2.checkConsistency();
+  CHECK(!G2._state_proxies_isGood, "");
+  for(uint i=1;i<fork->children.N;i++) CHECK_LE(fork->children(i-1)->ID, fork->children(i)->ID, "children are not in ID order, as in a fresh copy");
+  CHECK_ZERO(maxDiff(G2.getJointState(), G1.getJointState()), 1e-10, "");
+  CHECK_ZERO(maxDiff(G2.getFrameState(), G1.getFrameState()), 1e-10, "");
+  CHECK_EQ(STRING(G1), STRING(G2), "in-place copy differs");
+
+  //after a structural change, copy falls back to rebuilding all frames
+  G1.addFrame("extra", G1.frames.elem(3)->name)->setShape(rai::ST_box, {.1, .1, .1});
+  CHECK(!G2.hasSameStructure(G1), "");
+  G2.copy(G1);
+  G2.checkConsistency();
+  CHECK_EQ(STRING(G1), STRING(G2), "copy differs");
+
+  uint T=1000;
+  rai::timerStart();
+  for(uint k=0;k<T;k++) G2.copy(G1);
+  double tInPlace = rai::timerRead(true);
+  for(uint k=0;k<T;k++) rai::Configuration G3(G1);
+  double tFresh = rai::timerRead(true);
+  cout <<"copy of " <<G1.frames.N <<" frames [musec]: in-place recopy " <<1e6*tInPlace/T <<" fresh " <<1e6*tFresh/T <<endl;
+}
+
+//===========================================================================
+//
+// frame name index
+//
+
+void TEST(FrameNames){
+  rai::Configuration C;
+  rai::Frame *a = C.addFrame("a");
+  C.addFrame("b", "a");
+  rai::Frame *c = C.addFrame("c", "b");
+  C.addFrame("a");
+
+  CHECK_EQ(C.getFrame("a"), a, "");
+  CHECK_EQ(C.getFrame("a", true, true)->ID, 3, "");
+  CHECK(!C.getFrame("x", false), "");
+
+  //deletion and renaming
+  delete C.getFrame("b");
+  CHECK(!C.getFrame("b", false), "");
+  CHECK_EQ(C.getFrame("c"), c, "");
+  c->setName("y");
+  CHECK_EQ(C.getFrame("y"), c, "");
+  CHECK(!C.getFrame("c", false), "");
+  c->setName("x");
+  CHECK(!C.getFrame("y", false), "");
+  CHECK_EQ(C.getFrame("x"), c, "");
+  C.checkConsistency();
+
+  //copy and prefix
+  rai::Configuration D(C);
+  D.prefixNames();
+  CHECK_EQ(D.getFrame("_1_x")->ID, 1, "");
+  CHECK(!D.getFrame("x", false), "");
+  CHECK_EQ(C.getFrame("x"), c, "");
+
+  //time slices
+  rai::Configuration P;
+  for(uint t=0;t<5;t++) P.addConfiguration(C);
+  P.frames.reshape(5, C.frames.N);
+  for(uint t=0;t<5;t++) CHECK_EQ(P.getFrameInSlice("x", t)->ID, t*C.frames.N+1, "");
+  P.getFrameInSlice("x", 2)->setName("z");
+  CHECK_EQ(P.getFrameInSlice("z", 2)->ID, 2*C.frames.N+1, "");
+  CHECK(!P.getFrameInSlice("z", 3, false), "");
+  CHECK(!P.getFrameInSlice("x", 2, false), "");
+  CHECK_EQ(P.getFrameInSlice("x", 3)->ID, 3*C.frames.N+1, "");
+  CHECK_EQ(P.getFrame("x", true, true)->ID, 4*C.frames.N+1, "");
+}
+
+//===========================================================================
+//
+// binary scene cache
+//
+
+void TEST(SceneCache){
+  FILE("z.scene.base.g") <<"base { X:<t(0 0 .5)>, shape:box, size:[.2 .2 .2], mass:1 }\n"
+                          <<"arm (base) { joint:hingeX, Q:<t(0 0 .2)>, shape:box, size:[.1 .1 .4], mass:.5, color:[1 0 0] }\n";
+  FILE("z.scene.g") <<"Include: 'z.scene.base.g'\n"
+                     <<"eff (arm) { joint:transX, limits:[-1 1], Q:<t(0 0 .3)>, shape:cylinder, size:[.1 .02] }\n"
+                     <<"slider (base) { joint:hingeX, mimic:arm }\n";
+  rai::system("rm -f z.scene.g.cache");
+
+  rai::Configuration C("z.scene.g");
+  rai::Configuration D;
+  D.addFileCached("z.scene.g"); //compiles the cache
+  CHECK(rai::Configuration::checkCache("z.scene.g.cache"), "");
+  rai::Configuration E;
+  E.addFileCached("z.scene.g"); //only reads the cache
+  E.checkConsistency();
+
+  CHECK_EQ(C.frames.N, E.frames.N, "");
+  for(uint i=0;i<C.frames.N;i++){
+    rai::Frame *a=C.frames(i), *b=E.frames(i);
+    CHECK_EQ(a->name, b->name, "");
+    CHECK_EQ((a->parent?(int)a->parent->ID:-1), (b->parent?(int)b->parent->ID:-1), "");
+    CHECK_ZERO(maxDiff(a->ensure_X().getArr7d(), b->ensure_X().getArr7d()), 1e-10, "");
+    CHECK_EQ(!a->joint, !b->joint, "");
+    if(a->joint){
+      CHECK_EQ(a->joint->type, b->joint->type, "");
+      CHECK_EQ(a->joint->limits, b->joint->limits, "");
+      CHECK_EQ(!a->joint->mimic, !b->joint->mimic, "");
+    }
+    CHECK_EQ(!a->shape, !b->shape, "");
+    if(a->shape){
+      CHECK_EQ(a->shape->type(), b->shape->type(), "");
+      CHECK_EQ(a->shape->size, b->shape->size, "");
+      CHECK_EQ(a->shape->mesh().V, b->shape->mesh().V, "");
+      CHECK_EQ(a->shape->mesh().C, b->shape->mesh().C, "");
+    }
+    CHECK_EQ(!a->inertia, !b->inertia, "");
+    if(a->inertia) CHECK_EQ(a->inertia->mass, b->inertia->mass, "");
+  }
+  CHECK_ZERO(maxDiff(C.getJointState(), E.getJointState()), 1e-10, "");
+  C.setJointState(C.getJointState()+.1);
+  E.setJointState(E.getJointState()+.1);
+  CHECK_ZERO(maxDiff(C.getFrameState(), E.getFrameState()), 1e-10, "");
+
+  //touching a source file only leads to comparing its content
+  rai::system("touch z.scene.base.g");
+  CHECK(rai::Configuration::checkCache("z.scene.g.cache"), "");
+
+  //changing a source file invalidates the cache, also if its size stays the same
+  FILE("z.scene.base.g") <<"base { X:<t(0 0 .6)>, shape:box, size:[.2 .2 .2], mass:1 }\n"
+                          <<"arm (base) { joint:hingeX, Q:<t(0 0 .2)>, shape:box, size:[.1 .1 .4], mass:.5, color:[1 0 0] }\n";
+  CHECK(!rai::Configuration::checkCache("z.scene.g.cache"), "");
+  FILE("z.scene.base.g") <<"base { X:<t(0 0 .6)>, shape:box, size:[.2 .2 .2], mass:1 }\n";
+  CHECK(!rai::Configuration::checkCache("z.scene.g.cache"), "");
+}
+
 //===========================================================================
 //
 // Kinematic speed test
@@ -244,6 +396,279 @@ void TEST(KinematicSpeed){
 #endif
 }
 
+//===========================================================================
+//
+// setJointState only invalidates the branches of changed dofs
+//
+
+void TEST(IncrementalKinematics){
+  rai::Configuration C("kinematicTests.g"), E("kinematicTests.g");
+  arr q = C.getJointState();
+  C.setJointState(q);
+  C.getFrameState(); //all frames good
+
+  uint partial=0;
+  for(uint k=0;k<200;k++){
+    uint i = rnd(q.N);
+    q(i) += .1*rnd.gauss();
+    C.setJointState(q);
+
+    uint bad=0;
+    for(rai::Frame* f:C.frames) if(!f->isXgood()) bad++;
+    if(bad<C.frames.N-1) partial++;
+
+    E._state_q_isGood=false; //reference: the full update
+    E.setJointState(q);
+    CHECK_ZERO(maxDiff(C.getFrameState(), E.getFrameState()), 1e-10, "incremental kinematics differ");
+  }
+  CHECK(partial>0, "no update was incremental");
+
+  //unchanged state: nothing is invalidated
+  C.setJointState(q);
+  for(rai::Frame* f:C.frames) CHECK(f->isXgood(), "");
+}
+
+//===========================================================================
+//
+// all frame poses in one sweep over contiguous arrays, mirrored into a (frames.N,7)-array
+//
+
+void TEST(FlatKinematics){
+  rai::Configuration K("kinematicTests.g");
+  rai::Configuration C, E; //many copies, as in a KOMO pathConfig
+  for(uint t=0;t<50;t++){ C.addCopies(K.frames, K.otherDofs); E.addCopies(K.frames, K.otherDofs); }
+  cout <<"#frames: " <<C.frames.N <<endl;
+
+  arr q0 = C.getJointState(), q;
+  uint T=100;
+  double tFlat=0., tFrames=0.;
+  for(uint k=0;k<T;k++){
+    q = q0 + .1*randn(q0.N);
+    arr X, Y;
+    rai::timerStart();
+    C.setJointState(q);
+    X = C.getFrameState();
+    tFlat += rai::timerRead(true);
+    E.setJointState(q);
+    Y = E.getFrameState(E.frames); //the per-frame recursive ensure_X
+    tFrames += rai::timerRead();
+    CHECK_ZERO(maxDiff(X, Y), 1e-10, "flat kinematics differ");
+    for(rai::Frame* f:C.frames) CHECK(f->isXgood(), "the sweep must leave all frames good");
+    for(uint i=0;i<C.frames.N;i++) if(C.frames.elem(i)->joint){
+      CHECK_ZERO(maxDiff(C.frames.elem(i)->joint->axis.getArr(), E.frames.elem(i)->joint->axis.getArr()), 1e-10, "joint axes differ");
+    }
+  }
+  cout <<"flat sweep: " <<tFlat/T <<"sec per state, per-frame ensure_X: " <<tFrames/T <<"sec per state" <<endl;
+
+  //the mirror follows direct manipulation of frames...
+  rai::Frame* f = C.frames.elem(C.frames.N/2);
+  while(!f->parent) f = f->children.first();
+  f->set_Q()->addRelativeTranslation(.1, 0., 0.);
+  CHECK(!C._state_flatX_isGood, "");
+  CHECK_ZERO(maxDiff(C.getFrameState(), C.getFrameState(C.frames)), 1e-10, "");
+
+  //...and structural changes
+  rai::Frame* g = C.addFrame("flat_test");
+  g->setParent(f);
+  g->set_Q()->pos.set(0., 0., .2);
+  arr X = C.getFrameState();
+  CHECK_EQ(X.d0, C.frames.N, "");
+  CHECK_ZERO(maxDiff(X[g->ID], arr((f->ensure_X()*g->get_Q()).getArr7d())), 1e-10, "");
+  delete g;
+  CHECK_EQ(C.getFrameState().d0, C.frames.N, "");
+
+  //a new root frame right after a sweep
+  rai::Frame* r = C.addFrame("flat_root");
+  X = C.getFrameState();
+  CHECK_EQ(X.d0, C.frames.N, "");
+  CHECK_ZERO(maxDiff(X[r->ID], arr(r->ensure_X().getArr7d())), 1e-10, "");
+}
+
+//===========================================================================
+//
+// evaluate features for many joint states at once
+//
+
+void TEST(BatchEval){
+  rai::Configuration C("kinematicTests.g");
+  arr q0 = C.getJointState();
+  arr X0 = C.getFrameState();
+
+  uint N=100;
+  arr Q = repmat(~q0, N, 1);
+  rndGauss(Q, .1, true);
+
+  arr J;
+  arr y = C.batchEval(FS_position, {"arm5"}, Q, J);
+  CHECK_EQ(y.d0, N, "");
+  CHECK_EQ(J.d0, N, "");
+  CHECK_EQ(J.d2, q0.N, "");
+
+  //C is not touched
+  CHECK_ZERO(maxDiff(C.getJointState(), q0), 1e-10, "");
+  CHECK_ZERO(maxDiff(C.getFrameState(), X0), 1e-10, "");
+
+  //same as one state after the other
+  for(uint i=0;i<N;i++){
+    C.setJointState(Q[i]);
+    arr yi = C.evalFeature(FS_position, {"arm5"});
+    CHECK_ZERO(maxDiff(y[i], yi), 1e-10, "");
+    CHECK_ZERO(maxDiff(J[i], yi.J()), 1e-10, "");
+  }
+}
+
+//===========================================================================
+//
+// sparse Jacobians are set directly over the chain's columns
+//
+
+void TEST(SparseJacobians){
+  rai::Configuration C("kinematicTests.g"), D("kinematicTests.g");
+  C.jacMode = C.JM_sparse;
+  D.jacMode = D.JM_dense;
+
+  auto compare = [&](){
+    arr q = C.getJointState();
+    rndUniform(q, -.5, .5, false);
+    C.setJointState(q);
+    D.setJointState(q);
+    for(uint i=0;i<C.frames.N;i++){
+      rai::Frame *a=C.frames.elem(i), *b=D.frames.elem(i);
+      arr y, J, yd, Jd;
+      C.kinematicsPos(y, J, a);   D.kinematicsPos(yd, Jd, b);
+      CHECK(isSparse(J), "");
+      CHECK_ZERO(maxDiff(J.sparse().unsparse(), Jd), 1e-10, "");
+      C.kinematicsQuat(y, J, a);  D.kinematicsQuat(yd, Jd, b);
+      CHECK_ZERO(maxDiff(J.sparse().unsparse(), Jd), 1e-10, "");
+    }
+  };
+  compare();
+
+  //relinking changes the chains: cached columns are recomputed
+  C.getFrame("arm5")->unLink();  C.getFrame("arm5")->setParent(C.getFrame("stem"), true);
+  D.getFrame("arm5")->unLink();  D.getFrame("arm5")->setParent(D.getFrame("stem"), true);
+  compare();
+
+  //timing
+  rai::Frame *a = C.getFrame("arm4");
+  arr y, J;
+  uint T=100000;
+  rai::timerStart();
+  for(uint k=0;k<T;k++){ C.kinematicsPos(y, J, a); C.kinematicsVec(y, J, a, rai::Vector(1,0,0)); }
+  cout <<"sparse pos+vec Jacobians: " <<1e6*rai::timerRead()/T <<"musec" <<endl;
+}
+
+//===========================================================================
+//
+// Jacobian micro-benchmark on a chain of mixed joint types
+//
+
+void TEST(JacobianSpeed){
+  rai::Configuration C;
+  rai::Frame *f = C.addFrame("base");
+  rai::Array<rai::JointType> types = { rai::JT_hingeX, rai::JT_hingeY, rai::JT_hingeZ, rai::JT_transX, rai::JT_transXY,
+                                       rai::JT_transXYPhi, rai::JT_quatBall, rai::JT_free, rai::JT_trans3, rai::JT_phiTransXY };
+  for(uint i=0;i<30;i++){
+    rai::Frame *link = C.addFrame(STRING("link" <<i), f->name);
+    link->set_Q()->pos.set(0., 0., .1);
+    f = C.addFrame(STRING("joint" <<i), link->name);
+    new rai::Joint(*f, types(i%types.N));
+  }
+  rai::Frame *tip = f;
+
+  arr q = C.getJointState();
+  rndGauss(q, .1, true);
+  C.setJointState(q);
+
+  //sparse and dense agree, and the chain's Jacobians are correct
+  C.jacMode = C.JM_dense;
+  arr yd, Jd, y, J;
+  C.kinematicsPos(yd, Jd, tip);
+  C.jacMode = C.JM_sparse;
+  C.kinematicsPos(y, J, tip);
+  CHECK_ZERO(maxDiff(J.sparse().unsparse(), Jd), 1e-10, "");
+  VectorFunction pos = [&C, tip](const arr& x) -> arr { C.setJointState(x); return C.kinematics_pos(tip); };
+  C.jacMode = C.JM_dense;
+  CHECK(checkJacobian(pos, q, 1e-5), "");
+  C.setJointState(q);
+
+  //the chain caches are first filled within an evaluation arena, but must not pin it
+  rai::Frame *mid = C["joint25"];
+  {
+    rai::ArenaScope arena;
+    C.jacMode = C.JM_sparse;
+    C.kinematicsPos(y, J, mid);
+  }
+  CHECK(!C.jacobian_chain(mid).isArena && !C.jacobian_chainColumns(mid).isArena, "");
+
+  uint T=20000;
+  for(auto mode:{C.JM_dense, C.JM_sparse}){
+    C.jacMode = mode;
+    arr y, J;
+    rai::timerStart();
+    for(uint k=0;k<T;k++) C.kinematicsPos(y, J, tip);
+    double tPos = rai::timerRead(true);
+    for(uint k=0;k<T;k++) C.kinematicsVec(y, J, tip, rai::Vector(1,0,0));
+    double tVec = rai::timerRead(true);
+    for(uint k=0;k<T;k++) C.kinematicsQuat(y, J, tip);
+    double tQuat = rai::timerRead(true);
+    cout <<(mode==C.JM_dense?"dense ":"sparse") <<" Jacobians over " <<C.getJointStateDimension() <<" dofs [musec]: pos " <<1e6*tPos/T <<" vec " <<1e6*tVec/T <<" quat " <<1e6*tQuat/T <<endl;
+  }
+}
+
+//===========================================================================
+//
+// exact feature Hessians (second-order kinematics) vs. finite differences
+//
+
+void TEST(FeatureHessians){
+  rai::Configuration C;
+  rai::Frame *f = C.addFrame("base");
+  rai::Array<rai::JointType> types = { rai::JT_hingeX, rai::JT_transZ, rai::JT_hingeY, rai::JT_hingeZ, rai::JT_transX, rai::JT_hingeX, rai::JT_transY };
+  for(uint i=0;i<14;i++){
+    rai::Frame *link = C.addFrame(STRING("link" <<i), f->name);
+    link->set_Q()->pos.set(0., .05, .1);
+    f = C.addFrame(STRING("joint" <<i), link->name);
+    new rai::Joint(*f, types(i%types.N));
+  }
+  rai::Frame *tip = C.addFrame("tip", f->name);
+  tip->set_Q()->pos.set(.1, .2, .3);
+  tip->set_Q()->rot.setRandom();
+
+  arr q = C.getJointState();
+  rndGauss(q, .5, true);
+  C.setJointState(q);
+  C.jacMode = C.JM_dense;
+
+  for(FeatureSymbol fs:{FS_position, FS_positionDiff, FS_vectorZ, FS_quaternion}){
+    StringA frames = {"tip"};
+    if(fs==FS_positionDiff) frames.append("link5");
+    shared_ptr<Feature> feat = symbols2feature(fs, frames, C, {2.});
+    arr c = randn(feat->eval(C).N);
+    //f(q) = c^T y(q), whose Hessian is exactly what evalHessian returns
+    ScalarFunction fc = [&C, &feat, &c](arr& g, arr& H, const arr& x) -> double {
+      C.setJointState(x);
+      FrameL F = feat->getFrames(C);
+      arr y = feat->eval(F);
+      if(!!g){ g = ~c * y.J();  g.reshape(x.N); }
+      if(!!H){
+        arr Hc;
+        uintA cols;
+        CHECK(feat->evalHessian(Hc, cols, c, F), "");
+        H = zeros(x.N, x.N);
+        for(uint i=0;i<cols.N;i++) for(uint j=0;j<cols.N;j++) H(cols(i), cols(j)) += Hc(i,j);
+      }
+      return scalarProduct(c, y);
+    };
+    CHECK(checkHessian(fc, q, 1e-4), "");
+  }
+
+  //other joint types in the chain: no exact Hessian
+  new rai::Joint(*C["link3"], rai::JT_quatBall);
+  arr H;
+  CHECK(!C.hessian_pos(H, tip, tip->ensure_X().pos, {1., 0., 0.}), "");
+}
+
 //===========================================================================
 //
 // SWIFT and contacts test
@@ -646,12 +1071,21 @@ int MAIN(int argc,char **argv){
 
   testLoadSave();
   testCopy();
+  testCopyInPlace();
+  testFrameNames();
+  testSceneCache();
   testGraph();
   testPlayStateSequence();
   testViewerUpdate();
   testKinematics();
   testQuaternionKinematics();
   testKinematicSpeed();
+  testIncrementalKinematics();
+  testFlatKinematics();
+  testBatchEval();
+  testSparseJacobians();
+  testJacobianSpeed();
+  testFeatureHessians();
   testFollowRedundantSequence();
   testInverseKinematics();
   //testDynamics();
@@ -0,0 +1 @@
+base { X:<t(0 0 .6)>, shape:box, size:[.2 .2 .2], mass:1 }
@@ -0,0 +1,3 @@
+Include: 'z.scene.base.g'
+eff (arm) { joint:transX, limits:[-1 1], Q:<t(0 0 .3)>, shape:cylinder, size:[.1 .02] }
+slider (base) { joint:hingeX, mimic:arm }
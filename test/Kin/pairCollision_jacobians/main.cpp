@@ -195,7 +195,7 @@ void TEST(GJK_Jacobians3) {
   B1.set_Q()->pos.y += .03;
 //  B1.set_Q()->rot.addX(.01);
   s1.cont=s2.cont = true;
-  B1.name = "1"; B2.name="2";
+  B1.setName("1"); B2.setName("2");
 
   s1.type() = s2.type() = rai::ST_ssBox;
   s1.size = {.2, .2, .2, .01 };